@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR BSD-3-Clause
 
 #include <QHttpServer>
+#include <QHttpServerFileCache>
 #include <QHttpServerResponse>
 
 #if QT_CONFIG(ssl)
@@ -69,9 +70,7 @@ int main(int argc, char *argv[])
         };
     });
 
-    httpServer.route("/assets/<arg>", [] (const QUrl &url) {
-        return QHttpServerResponse::fromFile(u":/assets/"_s + url.path());
-    });
+    httpServer.route("/assets/<arg>", QHttpServerFileCache(u":/assets"_s));
 
     httpServer.route("/remote_address", [](const QHttpServerRequest &request) {
         return request.remoteAddress().toString();
@@ -10,6 +10,8 @@
 #include <private/qhttpserverrequest_p.h>
 #include <private/qhttpserverstream_p.h>
 
+#include <QtCore/qendian.h>
+#include <QtCore/qpointer.h>
 #include <QtCore/qloggingcategory.h>
 #include <QtNetwork/qtcpserver.h>
 #include <QtNetwork/qtcpsocket.h>
@@ -20,10 +22,20 @@
 #include <QtNetwork/qsslserver.h>
 #endif
 
+#if defined(Q_OS_UNIX)
+#include <private/qnet_unix_p.h>
+#include <netinet/in.h>
+#endif
+
 #include <algorithm>
+#include <cstring>
+#include <memory>
+#include <utility>
 
 QT_BEGIN_NAMESPACE
 
+using namespace Qt::StringLiterals;
+
 Q_LOGGING_CATEGORY(lcHttpServer, "qt.httpserver")
 
 /*!
@@ -43,10 +55,9 @@ void QAbstractHttpServerPrivate::handleNewConnections()
     Q_ASSERT(tcpServer);
 
     while (auto socket = tcpServer->nextPendingConnection())
-        new QHttpServerStream(q, socket);
+        createStream(socket);
 }
 
-
 #if QT_CONFIG(localserver)
 /*!
     \internal
@@ -58,9 +69,292 @@ void QAbstractHttpServerPrivate::handleNewLocalConnections()
     Q_ASSERT(localServer);
 
     while (auto socket = localServer->nextPendingConnection())
+        createStream(socket);
+}
+#endif
+
+/*!
+    \internal
+
+    Creates the stream handling \a socket, either in the current thread or,
+    if worker threads are configured, in the least loaded worker thread.
+*/
+void QAbstractHttpServerPrivate::createStream(QIODevice *socket)
+{
+    Q_Q(QAbstractHttpServer);
+
+    if (!reserveConnection()) {
+        delete socket;
+        return;
+    }
+
+    if (workerThreads.empty()) {
         new QHttpServerStream(q, socket);
+        return;
+    }
+
+    QHttpServerWorker *worker = leastLoadedWorker();
+    ++worker->connectionCount;
+
+    // Owns the socket until the worker creates its stream. If the worker
+    // stops before that, the queued call is dropped with it, and the
+    // connection is closed and no longer counted.
+    struct Handoff
+    {
+        Handoff(QAbstractHttpServerPrivate *d, QIODevice *socket, QHttpServerWorker *worker)
+            : d(d), socket(socket), worker(worker)
+        {
+        }
+        Q_DISABLE_COPY_MOVE(Handoff)
+
+        QAbstractHttpServerPrivate *const d;
+        QIODevice *socket;
+        const QPointer<QHttpServerWorker> worker;
+
+        ~Handoff()
+        {
+            if (!socket)
+                return;
+            delete socket;
+            if (worker)
+                --worker->connectionCount;
+            --d->connectionCount;
+        }
+    };
+    auto handoff = std::make_shared<Handoff>(this, socket, worker);
+
+    socket->setParent(nullptr);
+    socket->moveToThread(worker->thread());
+    QMetaObject::invokeMethod(
+            worker,
+            [q, handoff]() {
+                new QHttpServerStream(q, std::exchange(handoff->socket, nullptr),
+                                      handoff->worker);
+            },
+            Qt::QueuedConnection);
 }
+
+/*!
+    \internal
+
+    Counts a newly accepted connection. Returns \c false, and counts
+    nothing, if the maximum number of connections is reached.
+*/
+bool QAbstractHttpServerPrivate::reserveConnection()
+{
+    Q_Q(QAbstractHttpServer);
+
+    const int maxConnections = q->configuration().maxConnections();
+    int count = connectionCount.load(std::memory_order_relaxed);
+    do {
+        if (maxConnections > 0 && count >= maxConnections) {
+            qCDebug(lcHttpServer, "Connection limit of %d reached, closing connection",
+                    maxConnections);
+            return false;
+        }
+    } while (!connectionCount.compare_exchange_weak(count, count + 1,
+                                                    std::memory_order_relaxed));
+    return true;
+}
+
+/*!
+    \internal
+
+    Returns the timer wheel of the thread of \a worker, or of the thread of
+    the server if \a worker is \nullptr. It must be called from that thread.
+*/
+QHttpServerTimerWheel *QAbstractHttpServerPrivate::timerWheel(QHttpServerWorker *worker)
+{
+    std::unique_ptr<QHttpServerTimerWheel> &wheel =
+            worker ? worker->timerWheel : serverTimerWheel;
+    if (!wheel)
+        wheel = std::make_unique<QHttpServerTimerWheel>();
+    Q_ASSERT(wheel->thread() == QThread::currentThread());
+    return wheel.get();
+}
+
+/*!
+    \internal
+*/
+QHttpServerWorker *QAbstractHttpServerPrivate::leastLoadedWorker()
+{
+    Q_ASSERT(!workerThreads.empty());
+
+    // Start the search after the last picked worker, so that equally loaded
+    // workers are served round-robin.
+    const std::size_t count = workerThreads.size();
+    QHttpServerWorker *best = nullptr;
+    int bestLoad = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        const std::size_t index = (nextWorkerThread + i) % count;
+        QHttpServerWorker *worker = workerThreads[index].worker;
+        const int load = worker->connectionCount.load(std::memory_order_relaxed);
+        if (!best || load < bestLoad) {
+            best = worker;
+            bestLoad = load;
+            if (load == 0) {
+                nextWorkerThread = index + 1;
+                break;
+            }
+        }
+    }
+    if (bestLoad != 0)
+        ++nextWorkerThread;
+    nextWorkerThread %= count;
+    return best;
+}
+
+/*!
+    \internal
+*/
+void QAbstractHttpServerPrivate::startWorkerThreads(int count)
+{
+    workerThreads.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        auto thread = std::make_unique<QThread>();
+        thread->setObjectName(u"QHttpServer worker %1"_s.arg(i));
+
+        auto worker = new QHttpServerWorker;
+        worker->moveToThread(thread.get());
+        QObject::connect(thread.get(), &QThread::finished, worker, &QObject::deleteLater);
+
+        thread->start();
+        workerThreads.push_back({ std::move(thread), worker });
+    }
+}
+
+/*!
+    \internal
+
+    Stops all worker threads. The streams living in them are destroyed
+    together with their worker, closing the connections.
+*/
+void QAbstractHttpServerPrivate::stopWorkerThreads()
+{
+    for (auto &workerThread : workerThreads)
+        workerThread.thread->quit();
+    for (auto &workerThread : workerThreads)
+        workerThread.thread->wait();
+    workerThreads.clear();
+    nextWorkerThread = 0;
+    shardServers.clear();
+}
+
+/*!
+    \internal
+
+    Creates a server accepting connections on the listening
+    \a socketDescriptor. Must be called in the thread of \a worker.
+*/
+QTcpServer *QAbstractHttpServerPrivate::createShardServer(qintptr socketDescriptor,
+                                                          QHttpServerWorker *worker)
+{
+    Q_ASSERT(QThread::currentThread() == worker->thread());
+
+#if QT_CONFIG(ssl)
+    QTcpServer *tcpServer;
+    if (sslEnabled) {
+        auto sslServer = new QSslServer(worker);
+        sslServer->setSslConfiguration(sslConfiguration);
+        tcpServer = sslServer;
+    } else {
+        tcpServer = new QTcpServer(worker);
+    }
+#else
+    auto tcpServer = new QTcpServer(worker);
 #endif
+    if (!tcpServer->setSocketDescriptor(socketDescriptor)) {
+        qCCritical(lcHttpServer, "listen failed: %ls",
+                   qUtf16Printable(tcpServer->errorString()));
+        delete tcpServer;
+        return nullptr;
+    }
+
+    QObject::connect(tcpServer, &QTcpServer::pendingConnectionAvailable, tcpServer,
+                     [this, tcpServer, worker]() {
+                         handleNewShardConnections(tcpServer, worker);
+                     });
+    return tcpServer;
+}
+
+/*!
+    \internal
+
+    Accepted connections are handled in the thread they were accepted in,
+    no handover to another thread is needed.
+*/
+void QAbstractHttpServerPrivate::handleNewShardConnections(QTcpServer *tcpServer,
+                                                           QHttpServerWorker *worker)
+{
+    Q_Q(QAbstractHttpServer);
+    while (auto socket = tcpServer->nextPendingConnection()) {
+        if (!reserveConnection()) {
+            delete socket;
+            continue;
+        }
+        ++worker->connectionCount;
+        new QHttpServerStream(q, socket, worker);
+    }
+}
+
+#if defined(SO_REUSEPORT)
+/*!
+    \internal
+
+    Opens a listening TCP socket on \a address and \a port which other
+    sockets can bind to as well, letting the kernel balance incoming
+    connections between them. The bound port is stored into \a boundPort.
+
+    Returns the socket descriptor, or -1 on failure.
+*/
+static int openReusePortSocket(const QHostAddress &address, quint16 port, quint16 *boundPort)
+{
+    sockaddr_storage storage;
+    std::memset(&storage, 0, sizeof(storage));
+    socklen_t length;
+    int domain;
+    if (address.protocol() == QAbstractSocket::IPv4Protocol) {
+        auto in = reinterpret_cast<sockaddr_in *>(&storage);
+        in->sin_family = AF_INET;
+        in->sin_port = qToBigEndian(port);
+        in->sin_addr.s_addr = qToBigEndian(address.toIPv4Address());
+        domain = AF_INET;
+        length = sizeof(sockaddr_in);
+    } else {
+        auto in6 = reinterpret_cast<sockaddr_in6 *>(&storage);
+        in6->sin6_family = AF_INET6;
+        in6->sin6_port = qToBigEndian(port);
+        const Q_IPV6ADDR ip6 = address.toIPv6Address();
+        std::memcpy(&in6->sin6_addr, &ip6, sizeof(ip6));
+        domain = AF_INET6;
+        length = sizeof(sockaddr_in6);
+    }
+
+    const int fd = qt_safe_socket(domain, SOCK_STREAM, IPPROTO_TCP, O_NONBLOCK);
+    if (fd < 0)
+        return -1;
+
+    const int on = 1;
+    const int off = 0;
+    if (::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) != 0
+        || ::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) != 0
+        || (address.protocol() == QAbstractSocket::AnyIPProtocol
+            && ::setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off)) != 0)
+        || ::bind(fd, reinterpret_cast<sockaddr *>(&storage), length) != 0
+        || ::listen(fd, SOMAXCONN) != 0
+        || ::getsockname(fd, reinterpret_cast<sockaddr *>(&storage), &length) != 0) {
+        const int error = errno;
+        qt_safe_close(fd);
+        errno = error;
+        return -1;
+    }
+
+    *boundPort = qFromBigEndian(domain == AF_INET
+                                ? reinterpret_cast<sockaddr_in *>(&storage)->sin_port
+                                : reinterpret_cast<sockaddr_in6 *>(&storage)->sin6_port);
+    return fd;
+}
+#endif // SO_REUSEPORT
 
 /*!
     \class QAbstractHttpServer
@@ -84,7 +378,10 @@ QAbstractHttpServer::QAbstractHttpServer(QObject *parent)
     \internal
 */
 QAbstractHttpServer::~QAbstractHttpServer()
-    = default;
+{
+    Q_D(QAbstractHttpServer);
+    d->stopWorkerThreads();
+}
 
 /*!
     \internal
@@ -132,6 +429,74 @@ quint16 QAbstractHttpServer::listen(const QHostAddress &address, quint16 port)
     return 0;
 }
 
+/*!
+    \since 6.7
+
+    Tries to listen on \a address and \a port with one TCP server per worker
+    thread.
+
+    Every worker thread gets its own listening socket bound to the same
+    address and port with the \c SO_REUSEPORT socket option. The operating
+    system then distributes incoming connections between the sockets, and
+    each connection is accepted and handled entirely in the worker thread
+    owning the socket, so there is neither a single accept loop nor a
+    handover between threads.
+
+    If \a port is 0, a random port is picked and shared by all sockets.
+
+    Call setWorkerThreadCount() before calling this function. If no worker
+    threads are configured, or if the platform does not support
+    \c SO_REUSEPORT, this function falls back to listen().
+
+    The servers created by this function live in the worker threads and are
+    destroyed together with them.
+
+    Returns the server port upon success, 0 otherwise.
+
+    \sa listen(), setWorkerThreadCount()
+*/
+quint16 QAbstractHttpServer::listenSharded(const QHostAddress &address, quint16 port)
+{
+    Q_D(QAbstractHttpServer);
+    if (d->workerThreads.empty()) {
+        qCWarning(lcHttpServer, "No worker threads, listening with a single server");
+        return listen(address, port);
+    }
+
+#if defined(SO_REUSEPORT)
+    QList<int> socketDescriptors;
+    socketDescriptors.reserve(d->workerThreads.size());
+    for (std::size_t i = 0; i < d->workerThreads.size(); ++i) {
+        const int fd = openReusePortSocket(address, port, &port);
+        if (fd < 0) {
+            qCCritical(lcHttpServer, "listen failed: %ls", qUtf16Printable(qt_error_string()));
+            for (int socketDescriptor : std::as_const(socketDescriptors))
+                qt_safe_close(socketDescriptor);
+            return 0;
+        }
+        socketDescriptors.append(fd);
+    }
+
+    for (std::size_t i = 0; i < d->workerThreads.size(); ++i) {
+        QHttpServerWorker *worker = d->workerThreads[i].worker;
+        const int fd = socketDescriptors.at(qsizetype(i));
+        QTcpServer *tcpServer = nullptr;
+        QMetaObject::invokeMethod(
+                worker, [&]() { tcpServer = d->createShardServer(fd, worker); },
+                Qt::BlockingQueuedConnection);
+        if (tcpServer)
+            d->shardServers.append(tcpServer);
+        else
+            qt_safe_close(fd);
+    }
+
+    return d->shardServers.isEmpty() ? 0 : port;
+#else
+    qCWarning(lcHttpServer, "SO_REUSEPORT is not supported, listening with a single server");
+    return listen(address, port);
+#endif
+}
+
 /*!
     Returns the list of ports this instance of QAbstractHttpServer
     is listening to.
@@ -144,7 +509,7 @@ quint16 QAbstractHttpServer::listen(const QHostAddress &address, quint16 port)
 QList<quint16> QAbstractHttpServer::serverPorts()
 {
     QList<quint16> ports;
-    auto children = findChildren<QTcpServer *>();
+    auto children = servers();
     ports.reserve(children.size());
     std::transform(children.cbegin(), children.cend(), std::back_inserter(ports),
                    [](const QTcpServer *server) { return server->serverPort(); });
@@ -207,18 +572,103 @@ void QAbstractHttpServer::bind(QLocalServer *server)
 #endif
 
 /*!
-    Returns list of child TCP servers of this HTTP server.
+    Returns list of child TCP servers of this HTTP server, followed by the
+    servers created by listenSharded(), which live in the worker threads.
 
     \sa serverPorts()
  */
 QList<QTcpServer *> QAbstractHttpServer::servers() const
 {
-    return findChildren<QTcpServer *>();
+    Q_D(const QAbstractHttpServer);
+    return findChildren<QTcpServer *>() + d->shardServers;
+}
+
+/*!
+    \since 6.7
+
+    Sets the number of worker threads handling connections to \a count.
+
+    By default, the count is 0, and every connection is parsed, routed and
+    answered in the thread this HTTP server lives in. With a positive
+    \a count, the server starts \a count threads, each running its own event
+    loop, and hands every newly accepted connection over to the thread
+    currently serving the fewest connections. All requests arriving on that
+    connection are then handled in that thread.
+
+    When worker threads are used, handleRequest() and missingHandler() are
+    called concurrently from several threads, so their implementations, and
+    everything they access, must be thread-safe. The routes and handlers of
+    a QHttpServer must be fully set up before the first connection arrives.
+
+    Changing the count stops any previously started worker threads, which
+    closes the connections they serve. Subclasses that use worker threads
+    should call \c{setWorkerThreadCount(0)} in their destructor, so that no
+    request reaches a partially destroyed object.
+
+    \sa workerThreadCount()
+*/
+void QAbstractHttpServer::setWorkerThreadCount(int count)
+{
+    Q_D(QAbstractHttpServer);
+    if (count < 0) {
+        qCWarning(lcHttpServer, "Invalid worker thread count: %d", count);
+        return;
+    }
+
+    d->stopWorkerThreads();
+    if (count > 0)
+        d->startWorkerThreads(count);
+}
+
+/*!
+    \since 6.7
+
+    Returns the number of worker threads handling connections.
+
+    \sa setWorkerThreadCount()
+*/
+int QAbstractHttpServer::workerThreadCount() const
+{
+    Q_D(const QAbstractHttpServer);
+    return int(d->workerThreads.size());
+}
+
+/*!
+    \since 6.7
+
+    Sets the configuration of this server to \a configuration.
+
+    The configuration applies to the connections accepted after this call.
+    It can be changed while the server is running, also when worker threads
+    are used.
+
+    \sa configuration()
+*/
+void QAbstractHttpServer::setConfiguration(const QHttpServerConfiguration &configuration)
+{
+    Q_D(QAbstractHttpServer);
+    QMutexLocker locker(&d->configurationMutex);
+    d->configuration = configuration;
+}
+
+/*!
+    \since 6.7
+
+    Returns the configuration of this server.
+
+    \sa setConfiguration()
+*/
+QHttpServerConfiguration QAbstractHttpServer::configuration() const
+{
+    Q_D(const QAbstractHttpServer);
+    QMutexLocker locker(&d->configurationMutex);
+    return d->configuration;
 }
 
 #if QT_CONFIG(localserver)
 /*!
-    Returns list of child TCP servers of this HTTP server.
+    Returns list of child TCP servers of this HTTP server, followed by the
+    servers created by listenSharded(), which live in the worker threads.
 
     \sa serverPorts()
  */
@@ -7,6 +7,7 @@
 #include <QtCore/qobject.h>
 
 #include <QtHttpServer/qthttpserverglobal.h>
+#include <QtHttpServer/qhttpserverconfiguration.h>
 
 #include <QtNetwork/qhostaddress.h>
 
@@ -49,6 +50,13 @@ public:
     void bind(QTcpServer *server = nullptr);
     QList<QTcpServer *> servers() const;
 
+    void setWorkerThreadCount(int count);
+    int workerThreadCount() const;
+    quint16 listenSharded(const QHostAddress &address = QHostAddress::Any, quint16 port = 0);
+
+    void setConfiguration(const QHttpServerConfiguration &configuration);
+    QHttpServerConfiguration configuration() const;
+
 #if QT_CONFIG(localserver)
     void bind(QLocalServer *server);
     QList<QLocalServer *> localServers() const;
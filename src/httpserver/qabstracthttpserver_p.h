@@ -18,8 +18,11 @@
 #include <QtHttpServer/qthttpserverglobal.h>
 
 #include <private/qobject_p.h>
+#include <private/qhttpservertimerwheel_p.h>
 
 #include <QtCore/qcoreapplication.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qthread.h>
 
 #if defined(QT_WEBSOCKETS_LIB)
 #include <QtWebSockets/qwebsocketserver.h>
@@ -29,10 +32,31 @@
 #include <QtNetwork/qsslconfiguration.h>
 #endif
 
+#include <atomic>
+#include <memory>
+#include <vector>
+
 QT_BEGIN_NAMESPACE
 
 class QHttpServerRequest;
 
+class QHttpServerWorker : public QObject
+{
+public:
+    // Delete the streams while connectionCount is still alive
+    ~QHttpServerWorker() override
+    {
+        while (!children().isEmpty())
+            delete children().constFirst();
+    }
+
+    // Number of streams owned by this worker, read by the dispatching thread
+    std::atomic<int> connectionCount{0};
+
+    // Deadlines of the streams of this worker, created in its thread
+    std::unique_ptr<QHttpServerTimerWheel> timerWheel;
+};
+
 class QAbstractHttpServerPrivate: public QObjectPrivate
 {
 public:
@@ -40,6 +64,13 @@ public:
 
     QAbstractHttpServerPrivate();
 
+    // How the body of a request is read, asked once its headers are read
+    struct BodyPolicy {
+        bool stream = false; // the handler reads the body as it arrives
+        qint64 maxSize = -1; // negative for the limit of the configuration
+    };
+    virtual BodyPolicy requestBodyPolicy(const QHttpServerRequest &) const { return {}; }
+
 #if defined(QT_WEBSOCKETS_LIB)
     QWebSocketServer websocketServer {
         QCoreApplication::applicationName() + QLatin1Char('/') + QCoreApplication::applicationVersion(),
@@ -53,6 +84,35 @@ public:
     void handleNewLocalConnections();
 #endif
 
+    void createStream(QIODevice *socket);
+    bool reserveConnection();
+    QHttpServerTimerWheel *timerWheel(QHttpServerWorker *worker);
+
+    // Open connections of all threads, limited by maxConnections()
+    std::atomic<int> connectionCount{0};
+    // Deadlines of the streams living in the thread of the server
+    std::unique_ptr<QHttpServerTimerWheel> serverTimerWheel;
+
+    struct WorkerThread {
+        std::unique_ptr<QThread> thread;
+        QHttpServerWorker *worker; // lives in thread, deleted when it finishes
+    };
+    std::vector<WorkerThread> workerThreads;
+    std::size_t nextWorkerThread = 0;
+
+    void startWorkerThreads(int count);
+    void stopWorkerThreads();
+    QHttpServerWorker *leastLoadedWorker();
+
+    // Servers created by listenSharded(), each living in a worker thread
+    QList<QTcpServer *> shardServers;
+    QTcpServer *createShardServer(qintptr socketDescriptor, QHttpServerWorker *worker);
+    void handleNewShardConnections(QTcpServer *tcpServer, QHttpServerWorker *worker);
+
+    // Guarded by a mutex, as the streams of the worker threads copy it
+    mutable QMutex configurationMutex;
+    QHttpServerConfiguration configuration;
+
 #if QT_CONFIG(ssl)
     QSslConfiguration sslConfiguration;
     bool sslEnabled = false;
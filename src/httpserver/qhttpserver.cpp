@@ -8,6 +8,8 @@
 #include <QtHttpServer/qhttpserverresponse.h>
 
 #include <private/qhttpserver_p.h>
+#include <private/qhttpserverresponder_p.h>
+#include <private/qhttpserverresponse_p.h>
 #include <private/qhttpserverstream_p.h>
 
 #include <QtCore/qloggingcategory.h>
@@ -31,6 +33,47 @@ void QHttpServerPrivate::callMissingHandler(const QHttpServerRequest &request,
     }
 }
 
+/*!
+    \internal
+
+    Executes the route rule matching \a request. If the path of \a request
+    only matches rules for other methods, the missing handler is called if
+    one is set, and the request is otherwise answered with status
+    405 Method Not Allowed and an \c Allow header listing these methods.
+    Like any other response, it passes through the afterRequest() handlers.
+*/
+bool QHttpServerPrivate::handleRequest(const QHttpServerRequest &request,
+                                       QHttpServerResponder &responder)
+{
+    Q_Q(QHttpServer);
+
+    if (router.handleMatchingRule(request, responder))
+        return true;
+
+    QByteArray allow = router.allowedMethods(request);
+    if (allow.isEmpty())
+        return false;
+
+    if (missingHandler) {
+        missingHandler(request, std::move(responder));
+    } else {
+        qCDebug(lcHS) << "method not allowed:" << request.url().path();
+        QHttpServerResponse response(QHttpServerResponder::StatusCode::MethodNotAllowed);
+        response.setHeader(QByteArrayLiteral("Allow"), std::move(allow));
+        q->sendResponse(std::move(response), request, std::move(responder));
+    }
+    return true;
+}
+
+QAbstractHttpServerPrivate::BodyPolicy
+QHttpServerPrivate::requestBodyPolicy(const QHttpServerRequest &request) const
+{
+    const QHttpServerRouterRule *rule = router.matchingRule(request);
+    if (!rule)
+        return {};
+    return {rule->isStreamingBody(), rule->maxBodySize()};
+}
+
 /*!
     \class QHttpServer
     \since 6.4
@@ -92,6 +135,15 @@ QHttpServer::QHttpServer(QObject *parent)
 
     \endcode
 
+    A MIME type given between the methods and the callback is used for all
+    responses of the route that are created without one, which saves
+    detecting it from the data of every response:
+
+    \code
+    server.route("/hello", QHttpServerRequest::Method::Get, "text/plain"_ba,
+                 [] () { return "Hello world"; });
+    \endcode
+
     The request handler may return \c {QFuture<QHttpServerResponse>} if
     asynchronous processing is desired:
 
@@ -149,6 +201,9 @@ QHttpServer::QHttpServer(QObject *parent)
 */
 QHttpServer::~QHttpServer()
 {
+    // Worker threads may still route requests, stop them before the router
+    // and the handlers are destroyed.
+    setWorkerThreadCount(0);
 }
 
 /*!
@@ -173,7 +228,9 @@ QHttpServerRouter *QHttpServer::router()
     The invocable passed as \a handler will be invoked for each request
     that cannot be handled by any of registered route handlers. Passing a
     default-constructed std::function resets the handler to the default one
-    that produces replies with status 404 Not Found.
+    that produces replies with status 404 Not Found, or with status
+    405 Method Not Allowed if the path of the request matches route
+    handlers for other methods.
 */
 void QHttpServer::setMissingHandler(QHttpServer::MissingHandler handler)
 {
@@ -197,8 +254,10 @@ void QHttpServer::sendResponse(QHttpServerResponse &&response, const QHttpServer
                                QHttpServerResponder &&responder)
 {
     Q_D(QHttpServer);
+    response.d_func()->setDefaultContentType(responder.d_func()->defaultContentType);
     for (auto afterRequestHandler : d->afterRequestHandlers)
         response = afterRequestHandler(std::move(response), request);
+    responder.d_func()->evaluateConditions(response.d_func());
     responder.sendResponse(response);
 }
 
@@ -206,7 +265,10 @@ void QHttpServer::sendResponse(QHttpServerResponse &&response, const QHttpServer
 void QHttpServer::sendResponse(QFuture<QHttpServerResponse> &&response,
                                const QHttpServerRequest &request, QHttpServerResponder &&responder)
 {
-    response.then(this,
+    // Continue in the thread of the connection, which is not the thread of
+    // this server when worker threads are used.
+    QObject *context = responder.d_func()->stream;
+    response.then(context,
                   [this, &request,
                    responder = std::move(responder)](QHttpServerResponse &&response) mutable {
                       sendResponse(std::move(response), request, std::move(responder));
@@ -220,7 +282,7 @@ void QHttpServer::sendResponse(QFuture<QHttpServerResponse> &&response,
 bool QHttpServer::handleRequest(const QHttpServerRequest &request, QHttpServerResponder &responder)
 {
     Q_D(QHttpServer);
-    return d->router.handleRequest(request, responder);
+    return d->handleRequest(request, responder);
 }
 
 /*!
@@ -131,7 +131,13 @@ private:
                                      const QRegularExpressionMatch &match,
                                      const QHttpServerRequest &request,
                                      QHttpServerResponder &&responder) {
-            auto boundViewHandler = router()->bindCaptured(viewHandler, match);
+            bool ok = true;
+            auto boundViewHandler = router()->bindCaptured(viewHandler, match, &ok);
+            if (!ok) {
+                sendResponse(QHttpServerResponse(QHttpServerResponder::StatusCode::BadRequest),
+                             request, std::move(responder));
+                return;
+            }
             responseImpl<ViewTraits>(boundViewHandler, request, std::move(responder));
         };
 
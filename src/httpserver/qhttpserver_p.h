@@ -38,7 +38,9 @@ public:
     std::vector<QHttpServer::AfterRequestHandler> afterRequestHandlers;
     QHttpServer::MissingHandler missingHandler;
 
+    bool handleRequest(const QHttpServerRequest &request, QHttpServerResponder &responder);
     void callMissingHandler(const QHttpServerRequest &request, QHttpServerResponder &&responder);
+    BodyPolicy requestBodyPolicy(const QHttpServerRequest &request) const override;
 };
 
 QT_END_NAMESPACE
@@ -0,0 +1,207 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "qhttpserverconditional_p.h"
+#include "qhttpserverhttpdate_p.h"
+#include "qhttpserverliterals_p.h"
+#include "qhttpserverrequest_p.h"
+#include "qhttpserverresponse_p.h"
+
+#include <QtCore/qcryptographichash.h>
+#include <QtCore/qdatetime.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qtimezone.h>
+
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \internal
+
+    Returns a strong entity tag for a representation with the content
+    \a data. It is derived from a SHA-1 digest of the content, so it is
+    the same for the same content across connections, processes, machines
+    and Qt versions, as caches and server instances behind a load balancer
+    expect.
+*/
+QByteArray QHttpServerConditional::contentETag(QByteArrayView data)
+{
+    // 96 bits of the digest are plenty to tell versions of a resource apart
+    static constexpr qsizetype DigestSize = 12;
+    const QByteArray digest = QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+    return '"' + QByteArray::number(data.size(), 16) + '-'
+            + digest.first(DigestSize).toBase64(QByteArray::Base64UrlEncoding
+                                                | QByteArray::OmitTrailingEquals)
+            + '"';
+}
+
+/*!
+    \internal
+
+    Returns an entity tag for a file of \a size bytes that was last
+    modified at \a modified. The file is not read.
+*/
+QByteArray QHttpServerConditional::fileETag(qint64 size, const QDateTime &modified)
+{
+    return '"' + QByteArray::number(size, 16) + '-'
+            + QByteArray::number(modified.toMSecsSinceEpoch(), 16) + '"';
+}
+
+/*!
+    \internal
+
+    Returns \c true if the value \a list of an If-None-Match header
+    matches the entity tag \a etag, using the weak comparison of RFC 9110,
+    section 8.8.3.2. \c * matches any representation.
+*/
+bool QHttpServerConditional::etagListMatches(QByteArrayView list, QByteArrayView etag)
+{
+    const QByteArrayView opaqueTag = etag.startsWith("W/") ? etag.sliced(2) : etag;
+    qsizetype i = 0;
+    while (i < list.size()) {
+        const char c = list.at(i);
+        if (c == ' ' || c == '\t' || c == ',') {
+            ++i;
+            continue;
+        }
+        if (c == '*')
+            return true;
+
+        if (list.sliced(i).startsWith("W/"))
+            i += 2;
+        // Entity tags may contain commas, so the list is not split at them
+        if (i == list.size() || list.at(i) != '"')
+            return false;
+        const qsizetype end = list.indexOf('"', i + 1);
+        if (end < 0)
+            return false;
+        if (!opaqueTag.isEmpty() && list.sliced(i, end + 1 - i) == opaqueTag)
+            return true;
+        i = end + 1;
+    }
+    return false;
+}
+
+/*!
+    \internal
+
+    Returns \c true if \a request is a GET or HEAD request for which a
+    representation with the entity tag \a etag and the modification date
+    \a lastModified would be answered with \c{304 Not Modified}
+    (RFC 9110, section 13.2.2).
+
+    If-Modified-Since is only evaluated if the request has no
+    If-None-Match header.
+*/
+bool QHttpServerConditional::isNotModified(const QHttpServerRequestPrivate *request,
+                                           QByteArrayView etag, const QDateTime &lastModified)
+{
+    if (request->method != QHttpServerRequest::Method::Get
+        && request->method != QHttpServerRequest::Method::Head) {
+        return false;
+    }
+
+    if (!request->headerView("if-none-match").isNull())
+        return etagListMatches(request->headerField("if-none-match"), etag);
+
+    const QByteArrayView ifModifiedSince = request->headerView("if-modified-since");
+    if (ifModifiedSince.isNull() || !lastModified.isValid())
+        return false;
+    const QDateTime since = QHttpServerHttpDate::fromString(ifModifiedSince);
+    // HTTP dates have a resolution of one second
+    return since.isValid() && lastModified.toSecsSinceEpoch() <= since.toSecsSinceEpoch();
+}
+
+/*!
+    \internal
+
+    Adds an ETag header to a \c{200 OK} \a response to the GET or HEAD
+    \a request, if it has none, and turns it into \c{304 Not Modified} if
+    the validators of the request match.
+
+    The entity tag of a response from QHttpServerResponse::fromFile() that
+    is sent from the file is derived from the size and modification time of
+    the file, which then also provide a Last-Modified header. Other
+    responses get a hash of their data.
+*/
+void QHttpServerConditional::evaluate(QHttpServerResponsePrivate *response,
+                                      const QHttpServerRequestPrivate *request)
+{
+    if (response->statusCode != QHttpServerResponse::StatusCode::Ok
+        || (request->method != QHttpServerRequest::Method::Get
+            && request->method != QHttpServerRequest::Method::Head)) {
+        return;
+    }
+
+    QByteArray etag;
+    QByteArray lastModified;
+    for (const auto &header : response->headers) {
+        if (header.first.compare(QHttpServerLiterals::etagHeader(), Qt::CaseInsensitive) == 0)
+            etag = header.second;
+        else if (header.first.compare(QHttpServerLiterals::lastModifiedHeader(),
+                                      Qt::CaseInsensitive) == 0)
+            lastModified = header.second;
+    }
+
+    if (etag.isEmpty()) {
+        if (!response->fileName.isEmpty()) {
+            const QFileInfo info(response->fileName);
+            const QDateTime modified = info.lastModified(QTimeZone::UTC);
+            // Gone; the responder answers 404
+            if (!modified.isValid())
+                return;
+            etag = fileETag(info.size(), modified);
+            if (lastModified.isEmpty()) {
+                lastModified = QHttpServerHttpDate::toString(modified);
+                response->headers.emplace(QHttpServerLiterals::lastModifiedHeader(),
+                                          lastModified);
+            }
+        } else {
+            etag = contentETag(response->data);
+        }
+        response->headers.emplace(QHttpServerLiterals::etagHeader(), etag);
+    }
+
+    if (request->headerView("if-none-match").isNull()
+        && request->headerView("if-modified-since").isNull()) {
+        return;
+    }
+    const QDateTime modified = lastModified.isEmpty()
+            ? QDateTime()
+            : QHttpServerHttpDate::fromString(lastModified);
+    if (isNotModified(request, etag, modified))
+        makeNotModified(response);
+}
+
+/*!
+    \internal
+
+    Turns \a response into \c{304 Not Modified}. The body and the headers
+    that describe it are dropped, as caches would otherwise replace the
+    stored ones with them (RFC 9110, section 15.4.5). Validators and
+    caching headers such as ETag, Last-Modified, Cache-Control and Vary
+    are kept.
+*/
+void QHttpServerConditional::makeNotModified(QHttpServerResponsePrivate *response)
+{
+    static constexpr QByteArrayView representationHeaders[] = {
+        "Content-Type", "Content-Length", "Content-Encoding", "Content-Language", "Content-Range",
+    };
+
+    response->statusCode = QHttpServerResponse::StatusCode::NotModified;
+    response->data.clear();
+    response->fileName.clear();
+    response->contentTypePending = false;
+    for (auto it = response->headers.begin(); it != response->headers.end();) {
+        const QByteArray &name = it->first;
+        const bool isRepresentationHeader =
+                std::any_of(std::begin(representationHeaders), std::end(representationHeaders),
+                            [&name](QByteArrayView header) {
+                                return name.compare(header, Qt::CaseInsensitive) == 0;
+                            });
+        it = isRepresentationHeader ? response->headers.erase(it) : std::next(it);
+    }
+}
+
+QT_END_NAMESPACE
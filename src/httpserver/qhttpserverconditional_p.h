@@ -0,0 +1,42 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef QHTTPSERVERCONDITIONAL_P_H
+#define QHTTPSERVERCONDITIONAL_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists for the convenience
+// of QHttpServer. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+
+#include <QtHttpServer/qthttpserverglobal.h>
+
+#include <QtCore/qbytearray.h>
+
+QT_BEGIN_NAMESPACE
+
+class QDateTime;
+class QHttpServerRequestPrivate;
+class QHttpServerResponsePrivate;
+
+namespace QHttpServerConditional {
+
+QByteArray contentETag(QByteArrayView data);
+QByteArray fileETag(qint64 size, const QDateTime &modified);
+bool etagListMatches(QByteArrayView list, QByteArrayView etag);
+bool isNotModified(const QHttpServerRequestPrivate *request, QByteArrayView etag,
+                   const QDateTime &lastModified);
+
+void evaluate(QHttpServerResponsePrivate *response, const QHttpServerRequestPrivate *request);
+void makeNotModified(QHttpServerResponsePrivate *response);
+
+}
+
+QT_END_NAMESPACE
+
+#endif // QHTTPSERVERCONDITIONAL_P_H
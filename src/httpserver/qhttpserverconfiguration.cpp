@@ -0,0 +1,505 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtHttpServer/qhttpserverconfiguration.h>
+
+QT_BEGIN_NAMESPACE
+
+class QHttpServerConfigurationPrivate : public QSharedData
+{
+public:
+    bool dateHeader = false;
+    QByteArray serverHeader;
+    std::chrono::milliseconds keepAliveTimeout{0};
+    std::chrono::milliseconds headerReadTimeout{0};
+    std::chrono::milliseconds bodyReadTimeout{0};
+    std::chrono::milliseconds writeTimeout{0};
+    int maxRequestsPerConnection = 0;
+    int maxConnections = 0;
+    int pipelineDepth = 1;
+    qsizetype maxRequestLineSize = 8 * 1024;
+    qsizetype maxHeaderSize = 64 * 1024;
+    qsizetype maxHeaderCount = 100;
+    qint64 maxBodySize = 0;
+    qsizetype transferBufferSize = 1024 * 1024;
+    bool conditionalRequestHandling = false;
+};
+
+QT_DEFINE_QESDP_SPECIALIZATION_DTOR(QHttpServerConfigurationPrivate)
+
+/*!
+    \class QHttpServerConfiguration
+    \since 6.7
+    \inmodule QtHttpServer
+    \brief The QHttpServerConfiguration class controls server parameters.
+
+    QHttpServerConfiguration holds the settings of a QAbstractHttpServer
+    that are not specific to a route, such as the headers that are added to
+    every response. It is set with QAbstractHttpServer::setConfiguration().
+
+    \sa QAbstractHttpServer::setConfiguration()
+*/
+
+/*!
+    Constructs a default configuration.
+
+    By default, responses carry neither a \c Date nor a \c Server header,
+    and there are no limits on connections. Request lines are limited to
+    8 KiB, headers to 64 KiB and 100 fields, and bodies are not limited.
+*/
+QHttpServerConfiguration::QHttpServerConfiguration()
+    : d(new QHttpServerConfigurationPrivate)
+{
+}
+
+/*!
+    Copy-constructs this QHttpServerConfiguration from \a other.
+*/
+QHttpServerConfiguration::QHttpServerConfiguration(const QHttpServerConfiguration &other) = default;
+
+/*!
+    \fn QHttpServerConfiguration::QHttpServerConfiguration(QHttpServerConfiguration &&other) noexcept
+
+    Move-constructs this QHttpServerConfiguration from \a other.
+*/
+
+/*!
+    Copy-assigns \a other to this QHttpServerConfiguration.
+*/
+QHttpServerConfiguration &QHttpServerConfiguration::operator=(
+        const QHttpServerConfiguration &other) = default;
+
+/*!
+    \fn QHttpServerConfiguration &QHttpServerConfiguration::operator=(QHttpServerConfiguration &&other) noexcept
+
+    Move-assigns \a other to this QHttpServerConfiguration.
+*/
+
+/*!
+    Destroys this QHttpServerConfiguration.
+*/
+QHttpServerConfiguration::~QHttpServerConfiguration() = default;
+
+/*!
+    \fn void QHttpServerConfiguration::swap(QHttpServerConfiguration &other)
+
+    Swaps this configuration with \a other.
+*/
+
+/*!
+    Sets whether responses carry a \c Date header to \a enabled.
+
+    The header is formatted at most once per second in each thread that
+    sends responses, so enabling it costs almost nothing per response.
+    Handlers that write a \c Date header of their own replace it.
+
+    \sa isDateHeaderEnabled()
+*/
+void QHttpServerConfiguration::setDateHeaderEnabled(bool enabled)
+{
+    d.detach();
+    d->dateHeader = enabled;
+}
+
+/*!
+    Returns \c true if responses carry a \c Date header.
+
+    \sa setDateHeaderEnabled()
+*/
+bool QHttpServerConfiguration::isDateHeaderEnabled() const
+{
+    return d->dateHeader;
+}
+
+/*!
+    Sets the value of the \c Server header of responses to \a value.
+
+    An empty \a value, the default, means no \c Server header is added.
+    Handlers that write a \c Server header of their own replace it.
+
+    \sa serverHeader()
+*/
+void QHttpServerConfiguration::setServerHeader(const QByteArray &value)
+{
+    d.detach();
+    d->serverHeader = value;
+}
+
+/*!
+    Returns the value of the \c Server header of responses.
+
+    \sa setServerHeader()
+*/
+QByteArray QHttpServerConfiguration::serverHeader() const
+{
+    return d->serverHeader;
+}
+
+/*!
+    Sets the time a connection may stay open without a request to
+    \a timeout. This applies after the connection is accepted and after each
+    response. A connection that does not start a new request in time is
+    closed.
+
+    A \a timeout of zero, the default, keeps idle connections open for as
+    long as the client wants.
+
+    \sa keepAliveTimeout(), setHeaderReadTimeout()
+*/
+void QHttpServerConfiguration::setKeepAliveTimeout(std::chrono::milliseconds timeout)
+{
+    d.detach();
+    d->keepAliveTimeout = timeout;
+}
+
+/*!
+    Returns the time a connection may stay open without a request.
+
+    \sa setKeepAliveTimeout()
+*/
+std::chrono::milliseconds QHttpServerConfiguration::keepAliveTimeout() const
+{
+    return d->keepAliveTimeout;
+}
+
+/*!
+    Sets the time a client has to send the request line and the headers of
+    a request to \a timeout, counted from the first byte of the request.
+    The connection is closed if the headers are not complete in time, no
+    matter how slowly data keeps arriving.
+
+    A \a timeout of zero, the default, means no limit.
+
+    \sa headerReadTimeout(), setKeepAliveTimeout()
+*/
+void QHttpServerConfiguration::setHeaderReadTimeout(std::chrono::milliseconds timeout)
+{
+    d.detach();
+    d->headerReadTimeout = timeout;
+}
+
+/*!
+    Returns the time a client has to send the headers of a request.
+
+    \sa setHeaderReadTimeout()
+*/
+std::chrono::milliseconds QHttpServerConfiguration::headerReadTimeout() const
+{
+    return d->headerReadTimeout;
+}
+
+/*!
+    Sets the time a client may take between two parts of the body of a
+    request to \a timeout. The deadline is extended every time data
+    arrives, and the connection is closed if it passes.
+
+    A \a timeout of zero, the default, means no limit.
+
+    \sa bodyReadTimeout(), setHeaderReadTimeout()
+*/
+void QHttpServerConfiguration::setBodyReadTimeout(std::chrono::milliseconds timeout)
+{
+    d.detach();
+    d->bodyReadTimeout = timeout;
+}
+
+/*!
+    Returns the time a client may take between two parts of the body of a
+    request.
+
+    \sa setBodyReadTimeout()
+*/
+std::chrono::milliseconds QHttpServerConfiguration::bodyReadTimeout() const
+{
+    return d->bodyReadTimeout;
+}
+
+/*!
+    Sets the time a client may take to read pending response data to
+    \a timeout. The deadline runs while the socket has data to write and is
+    extended whenever some of it is written. If it passes, the connection is
+    aborted and the pending data is dropped.
+
+    A \a timeout of zero, the default, means no limit.
+
+    \sa writeTimeout()
+*/
+void QHttpServerConfiguration::setWriteTimeout(std::chrono::milliseconds timeout)
+{
+    d.detach();
+    d->writeTimeout = timeout;
+}
+
+/*!
+    Returns the time a client may take to read pending response data.
+
+    \sa setWriteTimeout()
+*/
+std::chrono::milliseconds QHttpServerConfiguration::writeTimeout() const
+{
+    return d->writeTimeout;
+}
+
+/*!
+    Sets the number of requests served on one connection to \a count. The
+    response to the last request carries a \c{Connection: close} header,
+    and the connection is closed once it is sent.
+
+    A \a count of zero, the default, means no limit.
+
+    \sa maxRequestsPerConnection()
+*/
+void QHttpServerConfiguration::setMaxRequestsPerConnection(int count)
+{
+    d.detach();
+    d->maxRequestsPerConnection = qMax(0, count);
+}
+
+/*!
+    Returns the number of requests served on one connection.
+
+    \sa setMaxRequestsPerConnection()
+*/
+int QHttpServerConfiguration::maxRequestsPerConnection() const
+{
+    return d->maxRequestsPerConnection;
+}
+
+/*!
+    Sets the number of connections the server keeps open at the same time
+    to \a count, across all worker threads. Connections accepted while the
+    limit is reached are closed immediately.
+
+    A \a count of zero, the default, means no limit.
+
+    \sa maxConnections()
+*/
+void QHttpServerConfiguration::setMaxConnections(int count)
+{
+    d.detach();
+    d->maxConnections = qMax(0, count);
+}
+
+/*!
+    Returns the number of connections the server keeps open at the same
+    time.
+
+    \sa setMaxConnections()
+*/
+int QHttpServerConfiguration::maxConnections() const
+{
+    return d->maxConnections;
+}
+
+/*!
+    Sets the number of requests of one connection that are handled at the
+    same time to \a depth.
+
+    HTTP/1.1 clients may send several requests without waiting for the
+    responses. With a \a depth greater than one, the server reads up to
+    \a depth requests ahead and passes them to their handlers right away,
+    so that asynchronous handlers run concurrently. The responses are still
+    sent in the order of the requests: a response that is ready before the
+    earlier ones is kept until they are sent.
+
+    The default \a depth of one handles the requests of a connection one
+    after the other. Values less than one are treated as one.
+
+    \sa pipelineDepth()
+*/
+void QHttpServerConfiguration::setPipelineDepth(int depth)
+{
+    d.detach();
+    d->pipelineDepth = qMax(1, depth);
+}
+
+/*!
+    Returns the number of requests of one connection that are handled at
+    the same time.
+
+    \sa setPipelineDepth()
+*/
+int QHttpServerConfiguration::pipelineDepth() const
+{
+    return d->pipelineDepth;
+}
+
+/*!
+    Sets the largest request line, the method, target and HTTP version of a
+    request, that the server accepts to \a size bytes.
+
+    Longer request lines are answered with status code 414 (URI Too Long)
+    as soon as \a size bytes are received without the end of the line, and
+    the connection is closed. A \a size of zero means no limit. The default
+    is 8 KiB.
+
+    \sa maxRequestLineSize()
+*/
+void QHttpServerConfiguration::setMaxRequestLineSize(qsizetype size)
+{
+    d.detach();
+    d->maxRequestLineSize = qMax(qsizetype(0), size);
+}
+
+/*!
+    Returns the largest request line the server accepts, in bytes.
+
+    \sa setMaxRequestLineSize()
+*/
+qsizetype QHttpServerConfiguration::maxRequestLineSize() const
+{
+    return d->maxRequestLineSize;
+}
+
+/*!
+    Sets the largest header block that the server accepts to \a size bytes.
+    The header block is everything after the request line up to and
+    including the empty line that ends it.
+
+    Larger header blocks are answered with status code 431 (Request Header
+    Fields Too Large) as soon as \a size bytes are received, and the
+    connection is closed. A \a size of zero means no limit. The default is
+    64 KiB.
+
+    \sa maxHeaderSize(), setMaxHeaderCount()
+*/
+void QHttpServerConfiguration::setMaxHeaderSize(qsizetype size)
+{
+    d.detach();
+    d->maxHeaderSize = qMax(qsizetype(0), size);
+}
+
+/*!
+    Returns the largest header block the server accepts, in bytes.
+
+    \sa setMaxHeaderSize()
+*/
+qsizetype QHttpServerConfiguration::maxHeaderSize() const
+{
+    return d->maxHeaderSize;
+}
+
+/*!
+    Sets the number of header fields that a request may have to \a count.
+
+    Requests with more header fields are answered with status code 431
+    (Request Header Fields Too Large), and the connection is closed. A
+    \a count of zero means no limit. The default is 100.
+
+    \sa maxHeaderCount(), setMaxHeaderSize()
+*/
+void QHttpServerConfiguration::setMaxHeaderCount(qsizetype count)
+{
+    d.detach();
+    d->maxHeaderCount = qMax(qsizetype(0), count);
+}
+
+/*!
+    Returns the number of header fields that a request may have.
+
+    \sa setMaxHeaderCount()
+*/
+qsizetype QHttpServerConfiguration::maxHeaderCount() const
+{
+    return d->maxHeaderCount;
+}
+
+/*!
+    Sets the largest request body that the server accepts to \a size bytes.
+
+    A request whose \c Content-Length exceeds \a size is answered with
+    status code 413 (Content Too Large) before its body is read, and the
+    connection is closed. A chunked body is rejected the same way as soon
+    as a chunk would take it past \a size. If the body of the request is
+    streamed to its handler, the body device is aborted instead, and the
+    connection is closed after the response.
+
+    A \a size of zero, the default, means no limit. Routes can override the
+    limit with QHttpServerRouterRule::setMaxBodySize().
+
+    \sa maxBodySize()
+*/
+void QHttpServerConfiguration::setMaxBodySize(qint64 size)
+{
+    d.detach();
+    d->maxBodySize = qMax(qint64(0), size);
+}
+
+/*!
+    Returns the largest request body the server accepts, in bytes.
+
+    \sa setMaxBodySize()
+*/
+qint64 QHttpServerConfiguration::maxBodySize() const
+{
+    return d->maxBodySize;
+}
+
+/*!
+    Sets the largest amount of data that is read at once from a QIODevice
+    that provides the body of a response to \a size bytes.
+
+    Reads start with 64 KiB, and grow up to \a size while the device
+    delivers full buffers, so that large downloads take few event loop
+    iterations. The server stops reading while the connection has more than
+    twice the current read size waiting to be sent. Larger sizes use more
+    memory per download. The default is 1 MiB. Sizes are limited to the
+    range from 4 KiB to 64 MiB.
+
+    \sa transferBufferSize(), QHttpServerResponder::write()
+*/
+void QHttpServerConfiguration::setTransferBufferSize(qsizetype size)
+{
+    d.detach();
+    d->transferBufferSize = qBound(qsizetype(4 * 1024), size, qsizetype(64 * 1024 * 1024));
+}
+
+/*!
+    Returns the largest amount of data that is read at once from a QIODevice
+    that provides the body of a response.
+
+    \sa setTransferBufferSize()
+*/
+qsizetype QHttpServerConfiguration::transferBufferSize() const
+{
+    return d->transferBufferSize;
+}
+
+/*!
+    Sets whether QHttpServer answers conditional requests by itself to
+    \a enabled.
+
+    When enabled, \c{200 OK} responses to GET and HEAD requests that a
+    QHttpServer route returns as a QHttpServerResponse get an \c ETag
+    header, unless they have one. It is a hash of the body, or is derived
+    from the size and modification time of a large file from
+    QHttpServerResponse::fromFile(), which then also gets a
+    \c Last-Modified header. If the \c If-None-Match or
+    \c If-Modified-Since header of the request matches, the response is
+    sent as \c{304 Not Modified} without a body.
+
+    This saves sending the body again, but not building it. Handlers
+    that can tell cheaply whether their data changed should use
+    QHttpServerRequest::isNotModified() before building the response
+    instead. Hashing the body costs a pass over it for each response. It
+    is disabled by default.
+
+    \sa isConditionalRequestHandlingEnabled(), QHttpServerRequest::isNotModified()
+*/
+void QHttpServerConfiguration::setConditionalRequestHandlingEnabled(bool enabled)
+{
+    d.detach();
+    d->conditionalRequestHandling = enabled;
+}
+
+/*!
+    Returns \c true if QHttpServer answers conditional requests by itself.
+
+    \sa setConditionalRequestHandlingEnabled()
+*/
+bool QHttpServerConfiguration::isConditionalRequestHandlingEnabled() const
+{
+    return d->conditionalRequestHandling;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,84 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef QHTTPSERVERCONFIGURATION_H
+#define QHTTPSERVERCONFIGURATION_H
+
+#include <QtHttpServer/qthttpserverglobal.h>
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qshareddata.h>
+
+#include <chrono>
+
+QT_BEGIN_NAMESPACE
+
+class QHttpServerConfigurationPrivate;
+QT_DECLARE_QESDP_SPECIALIZATION_DTOR_WITH_EXPORT(QHttpServerConfigurationPrivate, Q_HTTPSERVER_EXPORT)
+
+class Q_HTTPSERVER_EXPORT QHttpServerConfiguration
+{
+public:
+    QHttpServerConfiguration();
+    QHttpServerConfiguration(const QHttpServerConfiguration &other);
+    QHttpServerConfiguration(QHttpServerConfiguration &&other) noexcept = default;
+    QHttpServerConfiguration &operator=(const QHttpServerConfiguration &other);
+    QT_MOVE_ASSIGNMENT_OPERATOR_IMPL_VIA_PURE_SWAP(QHttpServerConfiguration)
+    ~QHttpServerConfiguration();
+
+    void swap(QHttpServerConfiguration &other) noexcept { d.swap(other.d); }
+
+    void setDateHeaderEnabled(bool enabled);
+    bool isDateHeaderEnabled() const;
+
+    void setServerHeader(const QByteArray &value);
+    QByteArray serverHeader() const;
+
+    void setKeepAliveTimeout(std::chrono::milliseconds timeout);
+    std::chrono::milliseconds keepAliveTimeout() const;
+
+    void setHeaderReadTimeout(std::chrono::milliseconds timeout);
+    std::chrono::milliseconds headerReadTimeout() const;
+
+    void setBodyReadTimeout(std::chrono::milliseconds timeout);
+    std::chrono::milliseconds bodyReadTimeout() const;
+
+    void setWriteTimeout(std::chrono::milliseconds timeout);
+    std::chrono::milliseconds writeTimeout() const;
+
+    void setMaxRequestsPerConnection(int count);
+    int maxRequestsPerConnection() const;
+
+    void setMaxConnections(int count);
+    int maxConnections() const;
+
+    void setPipelineDepth(int depth);
+    int pipelineDepth() const;
+
+    void setMaxRequestLineSize(qsizetype size);
+    qsizetype maxRequestLineSize() const;
+
+    void setMaxHeaderSize(qsizetype size);
+    qsizetype maxHeaderSize() const;
+
+    void setMaxHeaderCount(qsizetype count);
+    qsizetype maxHeaderCount() const;
+
+    void setMaxBodySize(qint64 size);
+    qint64 maxBodySize() const;
+
+    void setTransferBufferSize(qsizetype size);
+    qsizetype transferBufferSize() const;
+
+    void setConditionalRequestHandlingEnabled(bool enabled);
+    bool isConditionalRequestHandlingEnabled() const;
+
+private:
+    QExplicitlySharedDataPointer<QHttpServerConfigurationPrivate> d;
+};
+
+Q_DECLARE_SHARED(QHttpServerConfiguration)
+
+QT_END_NAMESPACE
+
+#endif // QHTTPSERVERCONFIGURATION_H
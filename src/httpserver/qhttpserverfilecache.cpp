@@ -0,0 +1,430 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtHttpServer/qhttpserverfilecache.h>
+
+#include <private/qhttpserverconditional_p.h>
+#include <private/qhttpserverhttpdate_p.h>
+#include <private/qhttpserverliterals_p.h>
+#include <private/qhttpservermimetypes_p.h>
+#include <private/qhttpserverresponse_p.h>
+
+#include <QtCore/qdatetime.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qfileinfo.h>
+#if QT_CONFIG(filesystemwatcher)
+#include <QtCore/qfilesystemwatcher.h>
+#endif
+#include <QtCore/qhash.h>
+#include <QtCore/qreadwritelock.h>
+#include <QtCore/qresource.h>
+
+#include <memory>
+
+QT_BEGIN_NAMESPACE
+
+// What QMimeDatabase reads of a file to detect its type from the content
+static constexpr qint64 MimeSniffSize = 16 * 1024;
+
+class QHttpServerFileCachePrivate : public QSharedData
+{
+public:
+    // What is known about a file, computed when it is first requested
+    struct Entry
+    {
+        QString filePath;
+        // The content, if it is held in memory, otherwise it is read from
+        // the file for each response
+        QByteArray data;
+        bool inMemory = false;
+        // The memory data takes, resources that are mapped take none
+        qint64 cost = 0;
+        QDateTime modified;
+        QByteArray mimeType;
+        QByteArray etag;
+        QByteArray lastModified;
+    };
+
+    // Shared with the file system watcher, which may outlive the cache
+    struct Entries
+    {
+        QReadWriteLock lock;
+        QHash<QString, std::shared_ptr<const Entry>> entries;
+        qint64 size = 0;
+
+        void remove(const QString &filePath);
+    };
+
+    explicit QHttpServerFileCachePrivate(const QString &rootPath);
+
+    QString resolve(const QString &path) const;
+    std::shared_ptr<const Entry> find(const QString &filePath) const;
+    std::shared_ptr<const Entry> load(const QString &filePath);
+    void watch(const QString &filePath, const QDateTime &modified);
+
+    const QString rootPath;
+    qint64 maxFileSize = 1024 * 1024;
+    qint64 maxSize = 64 * 1024 * 1024;
+    const std::shared_ptr<Entries> cache = std::make_shared<Entries>();
+#if QT_CONFIG(filesystemwatcher)
+    const std::unique_ptr<QFileSystemWatcher, QScopedPointerDeleteLater> watcher;
+#endif
+};
+
+QT_DEFINE_QESDP_SPECIALIZATION_DTOR(QHttpServerFileCachePrivate)
+
+/*!
+    \internal
+*/
+QHttpServerFileCachePrivate::QHttpServerFileCachePrivate(const QString &rootPath)
+    : rootPath(QDir::cleanPath(rootPath))
+#if QT_CONFIG(filesystemwatcher)
+    , watcher(new QFileSystemWatcher)
+#endif
+{
+#if QT_CONFIG(filesystemwatcher)
+    QObject::connect(watcher.get(), &QFileSystemWatcher::fileChanged, watcher.get(),
+                     [cache = std::weak_ptr<Entries>(cache),
+                      watcher = watcher.get()](const QString &filePath) {
+        // Replaced files are watched again once they are requested
+        watcher->removePath(filePath);
+        if (const auto entries = cache.lock())
+            entries->remove(filePath);
+    });
+#endif
+}
+
+/*!
+    \internal
+*/
+void QHttpServerFileCachePrivate::Entries::remove(const QString &filePath)
+{
+    QWriteLocker locker(&lock);
+    const auto it = entries.constFind(filePath);
+    if (it == entries.cend())
+        return;
+    size -= (*it)->cost;
+    entries.erase(it);
+}
+
+/*!
+    \internal
+
+    Returns the path of the file \a path refers to, or an empty string if
+    \a path leads out of the root directory.
+*/
+QString QHttpServerFileCachePrivate::resolve(const QString &path) const
+{
+    const QString prefix = rootPath.endsWith(u'/') ? rootPath : rootPath + u'/';
+    QString filePath = QDir::cleanPath(prefix + path);
+    if (!filePath.startsWith(prefix) || filePath.size() == prefix.size())
+        return {};
+    return filePath;
+}
+
+/*!
+    \internal
+*/
+std::shared_ptr<const QHttpServerFileCachePrivate::Entry>
+QHttpServerFileCachePrivate::find(const QString &filePath) const
+{
+    QReadLocker locker(&cache->lock);
+    std::shared_ptr<const Entry> entry = cache->entries.value(filePath);
+    locker.unlock();
+
+#if !QT_CONFIG(filesystemwatcher)
+    // Without a watcher, changes are noticed from the modification time
+    if (entry && QFileInfo(filePath).lastModified() != entry->modified) {
+        cache->remove(filePath);
+        return nullptr;
+    }
+#endif
+    return entry;
+}
+
+/*!
+    \internal
+
+    Reads what responses need about the file \a filePath and adds it to the
+    cache. Returns \c nullptr if the file cannot be read.
+*/
+std::shared_ptr<const QHttpServerFileCachePrivate::Entry>
+QHttpServerFileCachePrivate::load(const QString &filePath)
+{
+    if (!QFileInfo(filePath).isFile())
+        return nullptr;
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return nullptr;
+
+    auto entry = std::make_shared<Entry>();
+    entry->filePath = filePath;
+    entry->modified = file.fileTime(QFileDevice::FileModificationTime);
+    entry->mimeType = QHttpServerMimeTypes::forFileNameAndData(filePath,
+                                                              file.peek(MimeSniffSize));
+    const qint64 size = file.size();
+    if (entry->modified.isValid()) {
+        entry->etag = QHttpServerConditional::fileETag(size, entry->modified);
+        entry->lastModified = QHttpServerHttpDate::toString(entry->modified);
+    }
+
+    const bool isResource = filePath.startsWith(u':');
+    if (size <= maxFileSize) {
+        // Uncompressed resources are in memory already. Compressed ones are
+        // only mapped while the file is open.
+        if (isResource
+            && QResource(filePath).compressionAlgorithm() == QResource::NoCompression) {
+            if (const uchar *mapped = file.map(0, size))
+                entry->data = QByteArray::fromRawData(reinterpret_cast<const char *>(mapped), size);
+        }
+        if (entry->data.isNull()) {
+            entry->data = file.readAll();
+            if (entry->data.size() != size)
+                return nullptr;
+            entry->cost = size;
+        }
+        entry->inMemory = true;
+    }
+
+    QWriteLocker locker(&cache->lock);
+    // Another thread may have been faster
+    if (const auto it = cache->entries.constFind(filePath); it != cache->entries.cend())
+        return *it;
+    if (cache->size + entry->cost > maxSize) {
+        entry->data.clear();
+        entry->inMemory = false;
+        entry->cost = 0;
+    }
+    cache->size += entry->cost;
+    cache->entries.insert(filePath, entry);
+    locker.unlock();
+
+    if (!isResource)
+        watch(filePath, entry->modified);
+    return entry;
+}
+
+/*!
+    \internal
+
+    Removes the file \a filePath from the cache once it changes. \a modified
+    is the modification time the cache has seen.
+*/
+void QHttpServerFileCachePrivate::watch(const QString &filePath, const QDateTime &modified)
+{
+#if QT_CONFIG(filesystemwatcher)
+    // The watcher belongs to the thread that created the cache
+    QMetaObject::invokeMethod(watcher.get(), [cache = std::weak_ptr<Entries>(cache),
+                                              watcher = watcher.get(), filePath, modified]() {
+        watcher->addPath(filePath);
+        // Changes before the watch was set up are not reported
+        if (QFileInfo(filePath).lastModified() != modified) {
+            if (const auto entries = cache.lock())
+                entries->remove(filePath);
+        }
+    });
+#else
+    Q_UNUSED(filePath);
+    Q_UNUSED(modified);
+#endif
+}
+
+/*!
+    \class QHttpServerFileCache
+    \since 6.7
+    \inmodule QtHttpServer
+    \brief The QHttpServerFileCache class serves static files from a directory.
+
+    QHttpServerFileCache answers requests for the files in a directory, or
+    in a directory of the resource system. Unlike
+    QHttpServerResponse::fromFile(), it reads and inspects each file only
+    once. Its size, MIME type, \c ETag and \c Last-Modified headers are
+    kept, and files up to maxFileSize() are kept in memory. Responses for
+    larger files read the file as they are sent.
+
+    A cache can be used as the handler of a route directly:
+
+    \code
+    QHttpServer server;
+    server.route("/assets/<arg>", QHttpServerFileCache(u":/assets"_s));
+    \endcode
+
+    Files on disk are removed from the cache once they change or are
+    replaced, and read again on the next request. This relies on
+    QFileSystemWatcher, which reports changes to the thread that created
+    the cache. That thread needs to run an event loop.
+
+    Copies of a QHttpServerFileCache share the cached files and the
+    settings. Responses can be created from any thread.
+
+    \sa QHttpServerResponse::fromFile()
+*/
+
+/*!
+    Constructs a cache for the files below \a rootPath.
+
+    \a rootPath can be a directory of the resource system, such as
+    \c{:/assets}.
+*/
+QHttpServerFileCache::QHttpServerFileCache(const QString &rootPath)
+    : d(new QHttpServerFileCachePrivate(rootPath))
+{
+}
+
+/*!
+    Copy-constructs this QHttpServerFileCache from \a other. Both share the
+    cached files.
+*/
+QHttpServerFileCache::QHttpServerFileCache(const QHttpServerFileCache &other) = default;
+
+/*!
+    \fn QHttpServerFileCache::QHttpServerFileCache(QHttpServerFileCache &&other) noexcept
+
+    Move-constructs this QHttpServerFileCache from \a other.
+*/
+
+/*!
+    Copy-assigns \a other to this QHttpServerFileCache. Both share the
+    cached files.
+*/
+QHttpServerFileCache &QHttpServerFileCache::operator=(const QHttpServerFileCache &other) = default;
+
+/*!
+    \fn QHttpServerFileCache &QHttpServerFileCache::operator=(QHttpServerFileCache &&other) noexcept
+
+    Move-assigns \a other to this QHttpServerFileCache.
+*/
+
+/*!
+    Destroys this QHttpServerFileCache. The cached files are released
+    with the last copy.
+*/
+QHttpServerFileCache::~QHttpServerFileCache() = default;
+
+/*!
+    \fn void QHttpServerFileCache::swap(QHttpServerFileCache &other)
+
+    Swaps this cache with \a other.
+*/
+
+/*!
+    Returns the directory the files are served from.
+*/
+QString QHttpServerFileCache::rootPath() const
+{
+    return d->rootPath;
+}
+
+/*!
+    Sets the size up to which the content of a file is kept in memory to
+    \a size bytes. The default is 1 MiB.
+
+    Larger files are read as their responses are sent. Where the platform
+    supports it, the kernel then copies them to the socket directly.
+    Changing the size does not affect files that are cached already.
+
+    \sa maxFileSize(), setMaxSize()
+*/
+void QHttpServerFileCache::setMaxFileSize(qint64 size)
+{
+    d->maxFileSize = qMax(qint64(0), size);
+}
+
+/*!
+    Returns the size up to which the content of a file is kept in memory.
+
+    \sa setMaxFileSize()
+*/
+qint64 QHttpServerFileCache::maxFileSize() const
+{
+    return d->maxFileSize;
+}
+
+/*!
+    Sets the memory all the cached content may take to \a size bytes. The
+    default is 64 MiB.
+
+    Once the cache is full, further files are treated like files larger
+    than maxFileSize().
+
+    \sa maxSize(), size()
+*/
+void QHttpServerFileCache::setMaxSize(qint64 size)
+{
+    d->maxSize = qMax(qint64(0), size);
+}
+
+/*!
+    Returns the memory all the cached content may take.
+
+    \sa setMaxSize()
+*/
+qint64 QHttpServerFileCache::maxSize() const
+{
+    return d->maxSize;
+}
+
+/*!
+    Returns the memory the cached content takes.
+
+    Resources that are stored without compression are served from the
+    resource data, and take no memory.
+*/
+qint64 QHttpServerFileCache::size() const
+{
+    QReadLocker locker(&d->cache->lock);
+    return d->cache->size;
+}
+
+/*!
+    Returns a response with the content of the file \a path, relative to
+    rootPath().
+
+    The response carries \c ETag and \c Last-Modified headers, if the
+    modification time of the file is known. If \a path leads out of
+    rootPath() or the file cannot be read, the response has the status
+    \c{404 Not Found}.
+*/
+QHttpServerResponse QHttpServerFileCache::response(const QString &path) const
+{
+    const QString filePath = d->resolve(path);
+    if (filePath.isEmpty())
+        return QHttpServerResponse(QHttpServerResponse::StatusCode::NotFound);
+
+    auto entry = d->find(filePath);
+    if (!entry)
+        entry = d->load(filePath);
+    if (!entry)
+        return QHttpServerResponse(QHttpServerResponse::StatusCode::NotFound);
+
+    QHttpServerResponse response(entry->mimeType, entry->data);
+    if (!entry->inMemory)
+        response.d_func()->fileName = entry->filePath;
+    if (!entry->etag.isEmpty())
+        response.addHeader(QHttpServerLiterals::etagHeader(), entry->etag);
+    if (!entry->lastModified.isEmpty())
+        response.addHeader(QHttpServerLiterals::lastModifiedHeader(), entry->lastModified);
+    return response;
+}
+
+/*!
+    \fn QHttpServerResponse QHttpServerFileCache::operator()(const QUrl &path) const
+
+    Returns the response for the file at the path of \a path, so that the
+    cache can be the handler of a route.
+
+    \sa response()
+*/
+
+/*!
+    Removes all files from the cache.
+*/
+void QHttpServerFileCache::clear()
+{
+    QWriteLocker locker(&d->cache->lock);
+    d->cache->entries.clear();
+    d->cache->size = 0;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,53 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef QHTTPSERVERFILECACHE_H
+#define QHTTPSERVERFILECACHE_H
+
+#include <QtHttpServer/qhttpserverresponse.h>
+
+#include <QtCore/qshareddata.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qurl.h>
+
+QT_BEGIN_NAMESPACE
+
+class QHttpServerFileCachePrivate;
+QT_DECLARE_QESDP_SPECIALIZATION_DTOR_WITH_EXPORT(QHttpServerFileCachePrivate, Q_HTTPSERVER_EXPORT)
+
+class Q_HTTPSERVER_EXPORT QHttpServerFileCache
+{
+public:
+    explicit QHttpServerFileCache(const QString &rootPath);
+    QHttpServerFileCache(const QHttpServerFileCache &other);
+    QHttpServerFileCache(QHttpServerFileCache &&other) noexcept = default;
+    QHttpServerFileCache &operator=(const QHttpServerFileCache &other);
+    QT_MOVE_ASSIGNMENT_OPERATOR_IMPL_VIA_PURE_SWAP(QHttpServerFileCache)
+    ~QHttpServerFileCache();
+
+    void swap(QHttpServerFileCache &other) noexcept { d.swap(other.d); }
+
+    QString rootPath() const;
+
+    void setMaxFileSize(qint64 size);
+    qint64 maxFileSize() const;
+
+    void setMaxSize(qint64 size);
+    qint64 maxSize() const;
+
+    qint64 size() const;
+
+    QHttpServerResponse response(const QString &path) const;
+    QHttpServerResponse operator()(const QUrl &path) const { return response(path.path()); }
+
+    void clear();
+
+private:
+    QExplicitlySharedDataPointer<QHttpServerFileCachePrivate> d;
+};
+
+Q_DECLARE_SHARED(QHttpServerFileCache)
+
+QT_END_NAMESPACE
+
+#endif // QHTTPSERVERFILECACHE_H
@@ -0,0 +1,149 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "qhttpserverheaderscanner_p.h"
+
+#include <private/qsimd_p.h>
+
+QT_BEGIN_NAMESPACE
+
+// The header block of a request is searched for line feeds and colons.
+// On x86, the search compares 16 bytes at once with SSE2, which is always
+// available on x86-64, or 32 bytes at once with AVX2 when the CPU supports
+// it. Other platforms use a plain loop.
+
+static qsizetype indexOfEitherScalar(const char *data, qsizetype from, qsizetype size,
+                                     char c1, char c2)
+{
+    for (qsizetype i = from; i < size; ++i) {
+        if (data[i] == c1 || data[i] == c2)
+            return i;
+    }
+    return -1;
+}
+
+#if defined(__SSE2__)
+static qsizetype indexOfEitherSse2(const char *data, qsizetype from, qsizetype size,
+                                   char c1, char c2)
+{
+    const __m128i v1 = _mm_set1_epi8(c1);
+    const __m128i v2 = _mm_set1_epi8(c2);
+    qsizetype i = from;
+    for (; i + 16 <= size; i += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        const __m128i match = _mm_or_si128(_mm_cmpeq_epi8(chunk, v1), _mm_cmpeq_epi8(chunk, v2));
+        const uint mask = uint(_mm_movemask_epi8(match));
+        if (mask)
+            return i + qCountTrailingZeroBits(mask);
+    }
+    return indexOfEitherScalar(data, i, size, c1, c2);
+}
+#endif
+
+#if defined(QT_COMPILER_SUPPORTS_AVX2)
+QT_FUNCTION_TARGET(AVX2)
+static qsizetype indexOfEitherAvx2(const char *data, qsizetype from, qsizetype size,
+                                   char c1, char c2)
+{
+    const __m256i v1 = _mm256_set1_epi8(c1);
+    const __m256i v2 = _mm256_set1_epi8(c2);
+    qsizetype i = from;
+    for (; i + 32 <= size; i += 32) {
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        const __m256i match = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, v1),
+                                              _mm256_cmpeq_epi8(chunk, v2));
+        const uint mask = uint(_mm256_movemask_epi8(match));
+        if (mask)
+            return i + qCountTrailingZeroBits(mask);
+    }
+    return indexOfEitherSse2(data, i, size, c1, c2);
+}
+#endif
+
+/*!
+    \internal
+
+    Returns the index of the first occurrence of \a c1 or \a c2 in \a data,
+    searching from \a from on, or -1 if there is none.
+*/
+qsizetype QHttpServerHeaderScanner::indexOfEither(QByteArrayView data, qsizetype from,
+                                                  char c1, char c2)
+{
+#if defined(QT_COMPILER_SUPPORTS_AVX2)
+    if (qCpuHasFeature(AVX2))
+        return indexOfEitherAvx2(data.data(), from, data.size(), c1, c2);
+#endif
+#if defined(__SSE2__)
+    return indexOfEitherSse2(data.data(), from, data.size(), c1, c2);
+#else
+    return indexOfEitherScalar(data.data(), from, data.size(), c1, c2);
+#endif
+}
+
+/*!
+    \internal
+
+    Returns the index of the first occurrence of \a c in \a data, searching
+    from \a from on, or -1 if there is none.
+*/
+qsizetype QHttpServerHeaderScanner::indexOf(QByteArrayView data, qsizetype from, char c)
+{
+    return indexOfEither(data, from, c, c);
+}
+
+static bool isWhitespace(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+/*!
+    \internal
+
+    Splits the header \a block, which ends with an empty line, into header
+    fields and appends their name and value offsets to \a fields. Leading
+    and trailing whitespace is not part of the values.
+
+    Returns \c false if \a block is malformed. This includes obsolete line
+    folding (RFC 7230, section 3.2.4) and whitespace between field names
+    and colons, which must be rejected.
+*/
+bool QHttpServerHeaderScanner::scanFields(QByteArrayView block, Fields *fields)
+{
+    const char *data = block.data();
+    qsizetype lineBegin = 0;
+    while (lineBegin < block.size()) {
+        qsizetype colon = indexOfEither(block, lineBegin, ':', '\n');
+        qsizetype lineEnd = colon;
+        if (colon != -1 && data[colon] == ':')
+            lineEnd = indexOf(block, colon + 1, '\n');
+        else
+            colon = -1;
+        if (lineEnd == -1)
+            return false; // The block always ends with a line feed
+
+        qsizetype end = lineEnd;
+        if (end > lineBegin && data[end - 1] == '\r')
+            --end;
+
+        if (end == lineBegin)
+            return true; // Empty line, end of the header block
+
+        if (colon == -1 || colon == lineBegin || isWhitespace(data[lineBegin])
+            || isWhitespace(data[colon - 1])) {
+            return false;
+        }
+
+        qsizetype valueBegin = colon + 1;
+        while (valueBegin < end && isWhitespace(data[valueBegin]))
+            ++valueBegin;
+        qsizetype valueEnd = end;
+        while (valueEnd > valueBegin && isWhitespace(data[valueEnd - 1]))
+            --valueEnd;
+
+        fields->append({ lineBegin, colon - lineBegin, valueBegin, valueEnd - valueBegin });
+        lineBegin = lineEnd + 1;
+    }
+    return true;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,45 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef QHTTPSERVERHEADERSCANNER_P_H
+#define QHTTPSERVERHEADERSCANNER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists for the convenience
+// of QHttpServer. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+
+#include <QtHttpServer/qthttpserverglobal.h>
+
+#include <QtCore/qbytearrayview.h>
+#include <QtCore/qvarlengtharray.h>
+
+QT_BEGIN_NAMESPACE
+
+namespace QHttpServerHeaderScanner {
+
+struct Field
+{
+    qsizetype nameBegin;
+    qsizetype nameSize;
+    qsizetype valueBegin;
+    qsizetype valueSize;
+};
+
+using Fields = QVarLengthArray<Field, 32>;
+
+qsizetype indexOf(QByteArrayView data, qsizetype from, char c);
+qsizetype indexOfEither(QByteArrayView data, qsizetype from, char c1, char c2);
+
+bool scanFields(QByteArrayView block, Fields *fields);
+
+}
+
+QT_END_NAMESPACE
+
+#endif // QHTTPSERVERHEADERSCANNER_P_H
@@ -0,0 +1,61 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "qhttpserverhttpdate_p.h"
+
+#include <QtCore/qdatetime.h>
+#include <QtCore/qstringlist.h>
+#include <QtCore/qtimezone.h>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \internal
+
+    Formats \a dateTime as an IMF-fixdate (RFC 9110, section 5.6.7), the
+    format of the \c Date and \c Last-Modified headers. Milliseconds are
+    dropped.
+*/
+QByteArray QHttpServerHttpDate::toString(const QDateTime &dateTime)
+{
+    return dateTime.toTimeZone(QTimeZone::UTC)
+            .toString(u"ddd, dd MMM yyyy hh:mm:ss 'GMT'")
+            .toLatin1();
+}
+
+/*!
+    \internal
+
+    Parses the HTTP-date \a text (RFC 9110, section 5.6.7) and returns it in
+    UTC, or an invalid QDateTime if \a text is not a date. Besides the
+    IMF-fixdate, the obsolete RFC 850 and asctime() formats are accepted,
+    as recipients have to.
+*/
+QDateTime QHttpServerHttpDate::fromString(QByteArrayView text)
+{
+    const QStringList parts = QString::fromLatin1(text).simplified().split(u' ');
+    QDate date;
+    QTime time;
+    if (parts.size() == 6 && parts.at(5) == u"GMT") {
+        // Sun, 06 Nov 1994 08:49:37 GMT
+        date = QDate::fromString(parts.first(4).join(u' '), u"ddd, dd MMM yyyy");
+        time = QTime::fromString(parts.at(4), u"hh:mm:ss");
+    } else if (parts.size() == 4 && parts.at(3) == u"GMT") {
+        // Sunday, 06-Nov-94 08:49:37 GMT, where years more than 50 years in
+        // the future are in the past
+        date = QDate::fromString(parts.first(2).join(u' '), u"dddd, dd-MMM-yy",
+                                 QDate::currentDate().year() - 49);
+        time = QTime::fromString(parts.at(2), u"hh:mm:ss");
+    } else if (parts.size() == 5) {
+        // Sun Nov  6 08:49:37 1994
+        date = QDate::fromString(
+                QStringList{ parts.at(0), parts.at(1), parts.at(2), parts.at(4) }.join(u' '),
+                u"ddd MMM d yyyy");
+        time = QTime::fromString(parts.at(3), u"hh:mm:ss");
+    }
+    if (!date.isValid() || !time.isValid())
+        return {};
+    return QDateTime(date, time, QTimeZone::UTC);
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,34 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef QHTTPSERVERHTTPDATE_P_H
+#define QHTTPSERVERHTTPDATE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists for the convenience
+// of QHttpServer. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+
+#include <QtHttpServer/qthttpserverglobal.h>
+
+#include <QtCore/qbytearray.h>
+
+QT_BEGIN_NAMESPACE
+
+class QDateTime;
+
+namespace QHttpServerHttpDate {
+
+QByteArray toString(const QDateTime &dateTime);
+QDateTime fromString(QByteArrayView text);
+
+}
+
+QT_END_NAMESPACE
+
+#endif // QHTTPSERVERHTTPDATE_P_H
@@ -35,10 +35,64 @@ QByteArray QHttpServerLiterals::contentTypeJson()
     return ba;
 }
 
+QByteArray QHttpServerLiterals::contentTypeTextPlain()
+{
+    static QByteArray ba("text/plain");
+    return ba;
+}
+
+QByteArray QHttpServerLiterals::contentTypeXZeroSize()
+{
+    static QByteArray ba("application/x-zerosize");
+    return ba;
+}
+
 QByteArray QHttpServerLiterals::contentLengthHeader()
 {
     static QByteArray ba("Content-Length");
     return ba;
 }
 
+QByteArray QHttpServerLiterals::transferEncodingHeader()
+{
+    static QByteArray ba("Transfer-Encoding");
+    return ba;
+}
+
+QByteArray QHttpServerLiterals::transferEncodingChunked()
+{
+    static QByteArray ba("chunked");
+    return ba;
+}
+
+QByteArray QHttpServerLiterals::etagHeader()
+{
+    static QByteArray ba("ETag");
+    return ba;
+}
+
+QByteArray QHttpServerLiterals::lastModifiedHeader()
+{
+    static QByteArray ba("Last-Modified");
+    return ba;
+}
+
+QByteArray QHttpServerLiterals::acceptRangesHeader()
+{
+    static QByteArray ba("Accept-Ranges");
+    return ba;
+}
+
+QByteArray QHttpServerLiterals::acceptRangesBytes()
+{
+    static QByteArray ba("bytes");
+    return ba;
+}
+
+QByteArray QHttpServerLiterals::contentRangeHeader()
+{
+    static QByteArray ba("Content-Range");
+    return ba;
+}
+
 QT_END_NAMESPACE
@@ -26,7 +26,16 @@ QByteArray contentTypeHeader();
 QByteArray contentTypeXEmpty();
 QByteArray contentTypeTextHtml();
 QByteArray contentTypeJson();
+QByteArray contentTypeTextPlain();
+QByteArray contentTypeXZeroSize();
 QByteArray contentLengthHeader();
+QByteArray transferEncodingHeader();
+QByteArray transferEncodingChunked();
+QByteArray etagHeader();
+QByteArray lastModifiedHeader();
+QByteArray acceptRangesHeader();
+QByteArray acceptRangesBytes();
+QByteArray contentRangeHeader();
 
 }
 
@@ -0,0 +1,127 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "qhttpservermimetypes_p.h"
+
+#include <private/qhttpserverliterals_p.h>
+#include <private/qtools_p.h>
+
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qmimedatabase.h>
+#include <QtCore/qreadwritelock.h>
+
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE
+
+// Looking up a MIME type in QMimeDatabase means taking a global lock and
+// matching the data against every magic rule of the database. Responses
+// are mostly JSON, HTML or plain text, which are recognized here from the
+// first bytes. Everything else still goes through QMimeDatabase.
+
+namespace {
+
+// How much of the data is checked for being text
+constexpr qsizetype SniffSize = 512;
+
+bool isTextByte(char c)
+{
+    const uchar u = uchar(c);
+    if (u < 0x20)
+        return u == '\t' || u == '\n' || u == '\r';
+    return u != 0x7f;
+}
+
+bool startsWithNoCase(QByteArrayView text, const char *prefix)
+{
+    const qsizetype size = qsizetype(qstrlen(prefix));
+    return text.size() >= size && qstrnicmp(text.data(), size, prefix, size) == 0;
+}
+
+QByteArray forText(QByteArrayView data)
+{
+    const QByteArrayView head = data.first(std::min(data.size(), SniffSize));
+    if (!std::all_of(head.begin(), head.end(), isTextByte))
+        return {};
+
+    const QByteArrayView text = data.trimmed();
+    if (text.isEmpty())
+        return {};
+
+    const char first = text.front();
+    const char last = text.back();
+    if ((first == '{' && last == '}') || (first == '[' && last == ']'))
+        return QHttpServerLiterals::contentTypeJson();
+    if (startsWithNoCase(text, "<!doctype html") || startsWithNoCase(text, "<html"))
+        return QHttpServerLiterals::contentTypeTextHtml();
+    if (QtMiscUtils::isAsciiLetterOrNumber(first))
+        return QHttpServerLiterals::contentTypeTextPlain();
+    return {};
+}
+
+// Types of the file name suffixes that map to exactly one MIME type.
+struct SuffixCache
+{
+    QReadWriteLock lock;
+    QHash<QString, QByteArray> types;
+};
+
+Q_GLOBAL_STATIC(SuffixCache, suffixCache)
+
+} // namespace
+
+/*!
+    \internal
+
+    Returns the MIME type of \a data.
+*/
+QByteArray QHttpServerMimeTypes::forData(const QByteArray &data)
+{
+    if (data.isEmpty())
+        return QHttpServerLiterals::contentTypeXZeroSize();
+
+    QByteArray type = forText(data);
+    if (type.isEmpty())
+        type = QMimeDatabase().mimeTypeForData(data).name().toLatin1();
+    return type;
+}
+
+/*!
+    \internal
+
+    Returns the MIME type of the file \a fileName with the content \a data.
+
+    When the suffix of \a fileName names exactly one MIME type, that type is
+    remembered for the suffix and later files with the same suffix skip
+    QMimeDatabase. File names with more than one suffix, like
+    \c{archive.tar.gz}, are always looked up.
+*/
+QByteArray QHttpServerMimeTypes::forFileNameAndData(const QString &fileName,
+                                                    const QByteArray &data)
+{
+    const QFileInfo info(fileName);
+    QString suffix = info.suffix();
+    const bool cacheable = !suffix.isEmpty() && suffix.size() == info.completeSuffix().size();
+    if (cacheable) {
+        suffix = std::move(suffix).toLower();
+        QReadLocker locker(&suffixCache->lock);
+        const auto it = suffixCache->types.constFind(suffix);
+        if (it != suffixCache->types.cend())
+            return *it;
+    }
+
+    QMimeDatabase db;
+    const QMimeType mimeType = db.mimeTypeForFileNameAndData(fileName, data);
+    QByteArray type = mimeType.name().toLatin1();
+    if (cacheable) {
+        const QList<QMimeType> candidates = db.mimeTypesForFileName(fileName);
+        if (candidates.size() == 1 && candidates.first() == mimeType) {
+            QWriteLocker locker(&suffixCache->lock);
+            suffixCache->types.insert(suffix, type);
+        }
+    }
+    return type;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,33 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef QHTTPSERVERMIMETYPES_P_H
+#define QHTTPSERVERMIMETYPES_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists for the convenience
+// of QHttpServer. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+
+#include <QtHttpServer/qthttpserverglobal.h>
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qstringfwd.h>
+
+QT_BEGIN_NAMESPACE
+
+namespace QHttpServerMimeTypes {
+
+QByteArray forData(const QByteArray &data);
+QByteArray forFileNameAndData(const QString &fileName, const QByteArray &data);
+
+}
+
+QT_END_NAMESPACE
+
+#endif // QHTTPSERVERMIMETYPES_P_H
@@ -0,0 +1,230 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "qhttpserverrange_p.h"
+
+#include <QtCore/qrandom.h>
+#include <QtCore/private/qtools_p.h>
+
+#include <limits>
+
+QT_BEGIN_NAMESPACE
+
+// More ranges than this in one request are not worth the parts; the whole
+// representation is sent instead
+static constexpr qsizetype MaxRanges = 32;
+
+static bool parseNumber(QByteArrayView text, qint64 *value)
+{
+    if (text.isEmpty())
+        return false;
+    qint64 result = 0;
+    for (const char c : text) {
+        const int digit = c - '0';
+        if (!QtMiscUtils::isAsciiDigit(c)
+            || result > (std::numeric_limits<qint64>::max() - digit) / 10) {
+            return false;
+        }
+        result = result * 10 + digit;
+    }
+    *value = result;
+    return true;
+}
+
+/*!
+    \internal
+
+    Parses the value of a Range header (RFC 9110, section 14.2) for a
+    representation of \a size bytes. The satisfiable ranges are stored in
+    \a ranges, in the order of the request, and clamped to \a size.
+
+    Headers with an invalid range or another unit than bytes are ignored,
+    as are headers that ask for too many ranges or for more data than the
+    whole representation.
+*/
+QHttpServerRange::Result QHttpServerRange::parse(QByteArrayView value, qint64 size,
+                                                 QList<Range> *ranges)
+{
+    ranges->clear();
+    value = value.trimmed();
+    const qsizetype equals = value.indexOf('=');
+    if (equals < 0 || value.first(equals).trimmed().compare("bytes", Qt::CaseInsensitive) != 0)
+        return Result::Ignored;
+
+    bool hasRange = false;
+    qint64 total = 0;
+    QByteArrayView list = value.sliced(equals + 1);
+    while (!list.isEmpty()) {
+        const qsizetype comma = list.indexOf(',');
+        const QByteArrayView spec = (comma < 0 ? list : list.first(comma)).trimmed();
+        list = comma < 0 ? QByteArrayView() : list.sliced(comma + 1);
+        if (spec.isEmpty())
+            continue;
+
+        const qsizetype dash = spec.indexOf('-');
+        if (dash < 0)
+            return Result::Ignored;
+        hasRange = true;
+
+        Range range;
+        if (dash == 0) {
+            // The last bytes
+            qint64 suffix = 0;
+            if (!parseNumber(spec.sliced(1), &suffix))
+                return Result::Ignored;
+            if (suffix == 0 || size == 0)
+                continue;
+            range = { size - qMin(suffix, size), size - 1 };
+        } else {
+            qint64 first = 0;
+            qint64 last = size - 1;
+            if (!parseNumber(spec.first(dash), &first))
+                return Result::Ignored;
+            if (const QByteArrayView lastText = spec.sliced(dash + 1); !lastText.isEmpty()) {
+                if (!parseNumber(lastText, &last) || last < first)
+                    return Result::Ignored;
+                last = qMin(last, size - 1);
+            }
+            if (first >= size)
+                continue;
+            range = { first, last };
+        }
+
+        total += range.size();
+        if (ranges->size() == MaxRanges || total > size)
+            return Result::Ignored;
+        ranges->append(range);
+    }
+
+    if (!ranges->isEmpty())
+        return Result::Satisfiable;
+    return hasRange ? Result::Unsatisfiable : Result::Ignored;
+}
+
+/*!
+    \internal
+
+    Returns \c true if the validator \a ifRange of an If-Range header
+    matches the representation with the entity tag \a etag and the
+    modification date \a lastModified (RFC 9110, section 13.1.5). Weak
+    entity tags never match.
+*/
+bool QHttpServerRange::ifRangeMatches(QByteArrayView ifRange, QByteArrayView etag,
+                                      QByteArrayView lastModified)
+{
+    ifRange = ifRange.trimmed();
+    if (ifRange.startsWith("W/"))
+        return false;
+    if (ifRange.startsWith('"'))
+        return !etag.isEmpty() && !etag.startsWith("W/") && ifRange == etag;
+    return !lastModified.isEmpty() && ifRange == lastModified;
+}
+
+/*!
+    \internal
+
+    Returns the value of the Content-Range header for \a range of a
+    representation of \a size bytes.
+*/
+QByteArray QHttpServerRange::contentRange(const Range &range, qint64 size)
+{
+    return "bytes " + QByteArray::number(range.first) + '-' + QByteArray::number(range.last)
+            + '/' + QByteArray::number(size);
+}
+
+/*!
+    \internal
+
+    Creates a device that reads a multipart/byteranges body (RFC 9110,
+    section 14.6) with the \a ranges of \a source. Only the bytes in
+    \a ranges are read from \a source. Each part is labelled with
+    \a contentType, the type of the whole representation. Takes ownership
+    of \a source.
+*/
+QHttpServerRangeDevice::QHttpServerRangeDevice(QIODevice *source,
+                                               const QList<QHttpServerRange::Range> &ranges,
+                                               const QByteArray &contentType)
+    : source(source)
+{
+    source->setParent(this);
+    partBoundary = "QtHttpServer"
+            + QByteArray::number(QRandomGenerator::global()->generate64(), 16);
+
+    const qint64 size = source->size();
+    segments.reserve(2 * ranges.size() + 1);
+    for (const QHttpServerRange::Range &range : ranges) {
+        QByteArray header = segments.isEmpty() ? QByteArray() : QByteArray("\r\n");
+        header += "--" + partBoundary + "\r\n";
+        if (!contentType.isEmpty())
+            header += "Content-Type: " + contentType + "\r\n";
+        header += "Content-Range: " + QHttpServerRange::contentRange(range, size) + "\r\n\r\n";
+        const qint64 headerSize = header.size();
+        segments.append({ std::move(header), 0, headerSize });
+        segments.append({ QByteArray(), range.first, range.size() });
+    }
+    QByteArray end = "\r\n--" + partBoundary + "--\r\n";
+    const qint64 endSize = end.size();
+    segments.append({ std::move(end), 0, endSize });
+
+    for (const Segment &segment : std::as_const(segments))
+        totalSize += segment.size;
+    open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+}
+
+/*!
+    \internal
+*/
+bool QHttpServerRangeDevice::seek(qint64 pos)
+{
+    if (!QIODevice::seek(pos))
+        return false;
+    current = 0;
+    offset = pos;
+    while (current < segments.size() && offset >= segments[current].size) {
+        offset -= segments[current].size;
+        ++current;
+    }
+    return true;
+}
+
+/*!
+    \internal
+*/
+qint64 QHttpServerRangeDevice::readData(char *data, qint64 maxSize)
+{
+    qint64 total = 0;
+    while (total < maxSize && current < segments.size()) {
+        const Segment &segment = segments[current];
+        qint64 size = qMin(segment.size - offset, maxSize - total);
+        if (segment.text.isNull()) {
+            if (!source->seek(segment.start + offset))
+                return total > 0 ? total : -1;
+            size = source->read(data + total, size);
+            // The source got shorter than it was
+            if (size <= 0) {
+                setErrorString(size < 0 ? source->errorString()
+                                        : QStringLiteral("Unexpected end of data"));
+                return total > 0 ? total : -1;
+            }
+        } else {
+            memcpy(data + total, segment.text.constData() + offset, size_t(size));
+        }
+        total += size;
+        offset += size;
+        if (offset == segment.size) {
+            ++current;
+            offset = 0;
+        }
+    }
+    return total;
+}
+
+/*!
+    \internal
+*/
+qint64 QHttpServerRangeDevice::writeData(const char *, qint64)
+{
+    return -1;
+}
+
+QT_END_NAMESPACE
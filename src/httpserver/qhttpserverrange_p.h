@@ -0,0 +1,86 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef QHTTPSERVERRANGE_P_H
+#define QHTTPSERVERRANGE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists for the convenience
+// of QHttpServer. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+
+#include <QtHttpServer/qthttpserverglobal.h>
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qiodevice.h>
+#include <QtCore/qlist.h>
+
+QT_BEGIN_NAMESPACE
+
+namespace QHttpServerRange {
+
+// A range of bytes, both ends included
+struct Range
+{
+    qint64 first;
+    qint64 last;
+
+    qint64 size() const { return last - first + 1; }
+};
+
+enum class Result {
+    // The Range header is invalid or not worth honouring, the whole
+    // representation is sent
+    Ignored,
+    Satisfiable,
+    Unsatisfiable,
+};
+
+Result parse(QByteArrayView value, qint64 size, QList<Range> *ranges);
+bool ifRangeMatches(QByteArrayView ifRange, QByteArrayView etag, QByteArrayView lastModified);
+QByteArray contentRange(const Range &range, qint64 size);
+
+}
+
+class QHttpServerRangeDevice : public QIODevice
+{
+public:
+    QHttpServerRangeDevice(QIODevice *source, const QList<QHttpServerRange::Range> &ranges,
+                           const QByteArray &contentType);
+
+    QByteArray boundary() const { return partBoundary; }
+
+    bool isSequential() const override { return false; }
+    qint64 size() const override { return totalSize; }
+    bool seek(qint64 pos) override;
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+    qint64 writeData(const char *data, qint64 maxSize) override;
+
+private:
+    // A part of the body: either literal text, or a window of the source
+    struct Segment
+    {
+        QByteArray text;
+        qint64 start = 0;
+        qint64 size = 0;
+    };
+
+    QIODevice *const source;
+    QByteArray partBoundary;
+    QList<Segment> segments;
+    qint64 totalSize = 0;
+    // Where the next read continues
+    qsizetype current = 0;
+    qint64 offset = 0;
+};
+
+QT_END_NAMESPACE
+
+#endif // QHTTPSERVERRANGE_P_H
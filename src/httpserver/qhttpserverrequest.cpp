@@ -2,16 +2,21 @@
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
 
 #include "qhttpserverrequest_p.h"
+#include "qhttpserverconditional_p.h"
+#include "qhttpserverheaderscanner_p.h"
 
 #include <QtHttpServer/qhttpserverrequest.h>
 
 #include <QtCore/qdebug.h>
 #include <QtCore/qloggingcategory.h>
+#include <QtCore/private/qtools_p.h>
 #include <QtNetwork/qtcpsocket.h>
 #if QT_CONFIG(ssl)
 #include <QtNetwork/qsslsocket.h>
 #endif
 
+#include <limits>
+
 Q_LOGGING_CATEGORY(lc, "qt.httpserver.request")
 
 QT_BEGIN_NAMESPACE
@@ -51,6 +56,43 @@ Q_HTTPSERVER_EXPORT QDebug operator<<(QDebug debug, const QHttpServerRequest &re
 
 #endif
 
+/*!
+    \internal
+
+    Records the offsets of the path and the query of the request \a target,
+    which starts at \a offset of the header block.
+*/
+void QHttpServerRequestPrivate::setTargetOffsets(qsizetype offset, QByteArrayView target)
+{
+    qsizetype end = target.indexOf('#');
+    if (end == -1)
+        end = target.size();
+
+    // The absolute form carries the scheme and the authority before the path
+    qsizetype begin = 0;
+    if (!target.startsWith('/')) {
+        const qsizetype authority = target.indexOf("://");
+        if (authority != -1 && authority < end) {
+            begin = target.indexOf('/', authority + 3);
+            if (begin == -1 || begin > end)
+                begin = end;
+        }
+    }
+
+    qsizetype query = target.first(end).indexOf('?', begin);
+    if (query == -1) {
+        pathBegin = offset + begin;
+        pathSize = end - begin;
+        queryBegin = offset + end;
+        querySize = 0;
+    } else {
+        pathBegin = offset + begin;
+        pathSize = query - begin;
+        queryBegin = offset + query + 1;
+        querySize = end - query - 1;
+    }
+}
+
 /*!
     \internal
 */
@@ -71,6 +113,7 @@ bool QHttpServerRequestPrivate::parseRequestLine(QByteArrayView line)
         return false;
 
     const auto requestUrl = line.sliced(i, j - i);
+    setTargetOffsets(i, requestUrl);
     i = j + 1;
 
     while (i < line.size() && line[i] == ' ')
@@ -111,53 +154,233 @@ bool QHttpServerRequestPrivate::parseRequestLine(QByteArrayView line)
     return true;
 }
 
+/*!
+    \internal
+
+    Appends the data currently available in \a socket to the header block,
+    without consuming it from the socket. At most 16 KiB are appended at
+    once, so that a large body following the header is not copied. If
+    \a limit is not zero, the header block does not grow beyond it.
+
+    Returns the offset of the appended data in the header block, or -1 if
+    the socket could not be read.
+*/
+qsizetype QHttpServerRequestPrivate::peekHeaderBlock(QIODevice *socket, qsizetype limit)
+{
+    constexpr qint64 MaxPeekSize = 16 * 1024;
+
+    const qsizetype offset = headerBlock.size();
+    qint64 available = qMin(socket->bytesAvailable(), MaxPeekSize);
+    if (limit > 0)
+        available = qMin(available, qint64(limit - offset));
+    if (available <= 0)
+        return offset;
+
+    headerBlock.resize(offset + available);
+    const qint64 havePeeked = socket->peek(headerBlock.data() + offset, available);
+    if (havePeeked < 0) {
+        headerBlock.truncate(offset);
+        return -1;
+    }
+    headerBlock.truncate(offset + havePeeked);
+    return offset;
+}
+
+/*!
+    \internal
+
+    Consumes \a size bytes previously peeked at \a offset of the header
+    block from \a socket, and drops the remaining peeked bytes from the
+    header block.
+
+    Returns the number of bytes consumed, or -1 if the socket could not be
+    read.
+*/
+qsizetype QHttpServerRequestPrivate::consumeHeaderBlock(QIODevice *socket, qsizetype offset,
+                                                        qsizetype size)
+{
+    // Reading stores the same bytes at the same place, but advances the
+    // socket, which also works within a transaction
+    const qint64 haveRead = size > 0 ? socket->read(headerBlock.data() + offset, size) : 0;
+    if (haveRead != size)
+        return -1;
+    headerBlock.truncate(offset + size);
+    return size;
+}
+
 /*!
     \internal
 */
 qsizetype QHttpServerRequestPrivate::readRequestLine(QIODevice *socket)
 {
-    if (fragment.isEmpty()) {
-        // reserve bytes for the request line. This is better than always append() which reallocs
-        // the byte array
-        fragment.reserve(32);
+    if (headerBlock.isEmpty()) {
+        // according to
+        // https://maqentaer.com/devopera-static-backup/http/dev.opera.com/articles/view/mama-http-headers/index.html
+        // the average size of the header block is 381 bytes. reserve bytes for it and the
+        // request line. This is better than always append() which reallocs the byte array.
+        headerBlock.reserve(512);
     }
 
-    qsizetype bytes = 0;
-    char c;
-    qsizetype haveRead = 0;
+    // Peek one byte more than the request line and its CRLF may take, so
+    // that an overlong line is noticed without reading all of it
+    const qsizetype offset =
+            peekHeaderBlock(socket, maxRequestLineSize > 0 ? maxRequestLineSize + 3 : 0);
+    if (offset == -1)
+        return -1;
+    if (offset == headerBlock.size())
+        return 0; // read more later
+
+    qsizetype begin = offset;
+    if (offset == 0) {
+        // Ignore all whitespace that was trailing from a previous request on that socket
+        while (begin < headerBlock.size()) {
+            const char c = headerBlock.at(begin);
+            if (c != '\v' && c != '\n' && c != '\r' && c != ' ' && c != '\t')
+                break;
+            ++begin;
+        }
+    }
 
-    do {
-        haveRead = socket->read(&c, 1);
-        if (haveRead == -1)
-            return -1; // unexpected EOF
-        else if (haveRead == 0)
-            break; // read more later
-        else if (haveRead == 1 && fragment.size() == 0
-                 && (c == '\v' || c == '\n' || c == '\r' || c == ' ' || c == '\t'))
-            continue; // Ignore all whitespace that was trailing from a previous request on that
-                      // socket
-
-        bytes++;
-
-        // allow both CRLF & LF (only) line endings
-        if (c == '\n') {
-            // remove the CR at the end
-            if (fragment.endsWith('\r')) {
-                fragment.truncate(fragment.size() - 1);
-            }
-            bool ok = parseRequestLine(fragment);
-            state = State::ReadingHeader;
-            fragment.clear();
-            if (!ok) {
-                return -1;
-            }
-            break;
-        } else {
-            fragment.append(c);
+    // allow both CRLF & LF (only) line endings
+    const qsizetype lineEnd = QHttpServerHeaderScanner::indexOf(headerBlock, begin, '\n');
+    const qsizetype bytes = consumeHeaderBlock(socket, offset,
+                                               (lineEnd == -1 ? headerBlock.size() : lineEnd + 1)
+                                                       - offset);
+    if (bytes == -1)
+        return -1;
+
+    if (begin > offset)
+        headerBlock.remove(offset, begin - offset);
+
+    if (lineEnd == -1) {
+        if (maxRequestLineSize > 0 && headerBlock.size() > maxRequestLineSize + 1) {
+            error = Error::RequestLineTooLong;
+            return -1;
         }
-    } while (haveRead == 1);
+        return bytes;
+    }
 
-    return bytes;
+    // The request line stays at the beginning of the header block, the
+    // header fields follow it
+    headersBegin = headerBlock.size();
+    QByteArrayView line = QByteArrayView(headerBlock).first(headersBegin - 1);
+    if (line.endsWith('\r'))
+        line.chop(1);
+    if (maxRequestLineSize > 0 && line.size() > maxRequestLineSize) {
+        error = Error::RequestLineTooLong;
+        return -1;
+    }
+
+    const bool ok = parseRequestLine(line);
+    state = State::ReadingHeader;
+    if (!ok)
+        error = Error::Malformed;
+    return ok ? bytes : -1;
+}
+
+/*!
+    \internal
+
+    Returns the position of the line feed ending the header block, searching
+    the line feeds from \a from on, or -1 if the header block is not complete
+    yet.
+*/
+qsizetype QHttpServerRequestPrivate::findHeaderEnd(qsizetype from) const
+{
+    Q_ASSERT(from >= headersBegin && headersBegin > 0);
+
+    const char *data = headerBlock.constData();
+    qsizetype i = from;
+    while ((i = QHttpServerHeaderScanner::indexOf(headerBlock, i, '\n')) != -1) {
+        // As per HTTP rfc, the header endings will be marked by CRLFCRLF. But
+        // we will allow CRLFCRLF, CRLFLF, LFCRLF, LFLF.
+        // This also covers the case of no headers at all, as the header block
+        // follows the line feed ending the request line.
+        if (data[i - 1] == '\n')
+            return i;
+        if (data[i - 1] == '\r' && data[i - 2] == '\n')
+            return i;
+        ++i;
+    }
+    return -1;
+}
+
+/*!
+    \internal
+
+    Splits the header block, which ends with an empty line at \a headersEnd,
+    into header fields.
+
+    Returns \c false if the block is malformed or exceeds the limits of the
+    parser.
+*/
+bool QHttpServerRequestPrivate::parseHeaders(qsizetype headersEnd)
+{
+    const QByteArrayView block =
+            QByteArrayView(headerBlock).sliced(headersBegin, headersEnd - headersBegin);
+    if (!QHttpServerHeaderScanner::scanFields(block, &headerFields)) {
+        error = Error::Malformed;
+        return false;
+    }
+    if (maxHeaderCount > 0 && headerFields.size() > maxHeaderCount) {
+        error = Error::HeaderTooLarge;
+        return false;
+    }
+
+    const qsizetype maxFieldSize = parser.maxHeaderFieldSize();
+    for (auto &field : headerFields) {
+        if (field.nameSize + field.valueSize > maxFieldSize) {
+            error = Error::HeaderTooLarge;
+            return false;
+        }
+        field.nameBegin += headersBegin;
+        field.valueBegin += headersBegin;
+    }
+    return true;
+}
+
+/*!
+    \internal
+
+    Returns the value of the first header field named \a name, or a null
+    view if there is none.
+*/
+QByteArrayView QHttpServerRequestPrivate::headerView(QByteArrayView name) const
+{
+    const QByteArrayView block(headerBlock);
+    for (const auto &field : headerFields) {
+        if (field.nameSize == name.size()
+            && block.sliced(field.nameBegin, field.nameSize).compare(name, Qt::CaseInsensitive)
+                    == 0) {
+            return block.sliced(field.valueBegin, field.valueSize);
+        }
+    }
+    return {};
+}
+
+/*!
+    \internal
+
+    Returns the values of all header fields named \a name, separated by
+    commas.
+*/
+QByteArray QHttpServerRequestPrivate::headerField(QByteArrayView name) const
+{
+    const QByteArrayView block(headerBlock);
+    QByteArray result;
+    bool found = false;
+    for (const auto &field : headerFields) {
+        if (field.nameSize != name.size()
+            || block.sliced(field.nameBegin, field.nameSize).compare(name, Qt::CaseInsensitive)
+                    != 0) {
+            continue;
+        }
+        if (found)
+            result.append(", ");
+        result.append(block.sliced(field.valueBegin, field.valueSize));
+        found = true;
+    }
+    return result;
 }
 
 /*!
@@ -166,7 +389,7 @@ qsizetype QHttpServerRequestPrivate::readRequestLine(QIODevice *socket)
 qint64 QHttpServerRequestPrivate::contentLength() const
 {
     bool ok = false;
-    QByteArray value = parser.firstHeaderField("content-length");
+    const QByteArrayView value = headerView("content-length");
     qint64 length = value.toULongLong(&ok);
     if (ok)
         return length;
@@ -175,55 +398,55 @@ qint64 QHttpServerRequestPrivate::contentLength() const
 
 /*!
     \internal
+
+    Returns \c true if the comma separated \a value contains \a token,
+    compared case insensitively.
 */
-qsizetype QHttpServerRequestPrivate::readHeader(QIODevice *socket)
+static bool containsToken(QByteArrayView value, QByteArrayView token)
 {
-    if (fragment.isEmpty()) {
-        // according to
-        // https://maqentaer.com/devopera-static-backup/http/dev.opera.com/articles/view/mama-http-headers/index.html
-        // the average size of the header block is 381 bytes. reserve bytes. This is better than
-        // always append() which reallocs the byte array.
-        fragment.reserve(512);
+    while (!value.isEmpty()) {
+        qsizetype comma = value.indexOf(',');
+        if (comma == -1)
+            comma = value.size();
+        if (value.first(comma).trimmed().compare(token, Qt::CaseInsensitive) == 0)
+            return true;
+        value = value.sliced(qMin(comma + 1, value.size()));
     }
+    return false;
+}
 
-    qint64 bytes = 0;
-    char c = 0;
-    bool allHeaders = false;
-    qint64 haveRead = 0;
-    do {
-        haveRead = socket->read(&c, 1);
-        if (haveRead == 0) {
-            // read more later
-            break;
-        } else if (haveRead == -1) {
-            // connection broke down
-            return -1;
-        } else {
-            fragment.append(c);
-            bytes++;
-
-            if (c == '\n') {
-                // check for possible header endings. As per HTTP rfc,
-                // the header endings will be marked by CRLFCRLF. But
-                // we will allow CRLFCRLF, CRLFLF, LFCRLF, LFLF
-                if (fragment.endsWith("\n\r\n") || fragment.endsWith("\n\n"))
-                    allHeaders = true;
-
-                // there is another case: We have no headers. Then the fragment equals just the line
-                // ending
-                if ((fragment.size() == 2 && fragment.endsWith("\r\n"))
-                    || (fragment.size() == 1 && fragment.endsWith("\n")))
-                    allHeaders = true;
-            }
-        }
-    } while (!allHeaders && haveRead > 0);
+/*!
+    \internal
+*/
+qsizetype QHttpServerRequestPrivate::readHeader(QIODevice *socket)
+{
+    const qsizetype offset =
+            peekHeaderBlock(socket, maxHeaderSize > 0 ? headersBegin + maxHeaderSize + 1 : 0);
+    if (offset == -1)
+        return -1;
+    if (offset == headerBlock.size())
+        return 0; // read more later
+
+    const qsizetype headerEnd = findHeaderEnd(offset);
+    const bool allHeaders = headerEnd != -1;
+    const qsizetype bytes = consumeHeaderBlock(socket, offset,
+                                               (allHeaders ? headerEnd + 1 : headerBlock.size())
+                                                       - offset);
+    if (bytes == -1)
+        return -1;
+
+    // The header fields and the empty line ending them count
+    if (maxHeaderSize > 0 && headerBlock.size() - headersBegin > maxHeaderSize) {
+        error = Error::HeaderTooLarge;
+        return -1;
+    }
 
     // we received all headers now parse them
     if (allHeaders) {
-        parser.parseHeaders(fragment);
-        fragment.clear(); // next fragment
+        if (!parseHeaders(headerBlock.size()))
+            return -1;
 
-        auto hostUrl = QString::fromUtf8(headerField("host"));
+        auto hostUrl = QString::fromUtf8(headerView("host"));
         if (!hostUrl.isEmpty())
             url.setAuthority(hostUrl);
 
@@ -247,13 +470,20 @@ qsizetype QHttpServerRequestPrivate::readHeader(QIODevice *socket)
         // cache isChunked() since it is called often
         // FIXME: the RFC says that anything but "identity" should be interpreted as chunked (4.4
         // [2])
-        chunkedTransferEncoding = headerField("transfer-encoding").toLower().contains("chunked");
-
-        QByteArray connectionHeaderField = headerField("connection");
-        upgrade = connectionHeaderField.toLower().contains("upgrade");
+        const QByteArray transferEncoding = headerField("transfer-encoding");
+        chunkedTransferEncoding = containsToken(transferEncoding, "chunked");
+
+        const QByteArray connectionHeaderField = headerField("connection");
+        upgrade = containsToken(connectionHeaderField, "upgrade");
+        // HTTP/1.1 connections are persistent unless closed explicitly,
+        // HTTP/1.0 ones only if the client asks for it
+        if (parser.getMajorVersion() == 1 && parser.getMinorVersion() == 0)
+            keepAlive = containsToken(connectionHeaderField, "keep-alive");
+        else
+            keepAlive = !containsToken(connectionHeaderField, "close");
 
         if (chunkedTransferEncoding || bodyLength > 0) {
-            if (headerField("expect").compare("100-continue", Qt::CaseInsensitive) == 0)
+            if (headerView("expect").compare("100-continue", Qt::CaseInsensitive) == 0)
                 state = State::ExpectContinue;
             else
                 state = State::ReadingData;
@@ -309,6 +539,8 @@ bool QHttpServerRequestPrivate::parse(QIODevice *socket)
             continue;
         case State::ReadingHeader:
             read = readHeader(socket);
+            if (state != State::ReadingHeader && state != State::AllDone && !bodyModeChosen)
+                return true; // The stream chooses where the body goes first
             continue;
         case State::ExpectContinue:
             read = sendContinue(socket);
@@ -319,9 +551,10 @@ bool QHttpServerRequestPrivate::parse(QIODevice *socket)
             else
                 read = readBodyFast(socket);
 
-            if (state == State::AllDone) {
-                body = bodyBuffer.readAll();
-                bodyBuffer.clear();
+            if (bodyDevice) {
+                bodyDevice->notifyReadyRead();
+                if (state == State::AllDone)
+                    bodyDevice->finish();
             }
 
             continue;
@@ -338,43 +571,96 @@ bool QHttpServerRequestPrivate::parse(QIODevice *socket)
 void QHttpServerRequestPrivate::clear()
 {
     parser.clear();
+    // Keep the capacity for the next request on the connection
+    headerBlock.truncate(0);
+    headersBegin = 0;
+    pathBegin = 0;
+    pathSize = 0;
+    queryBegin = 0;
+    querySize = 0;
+    headerFields.clear();
     bodyLength = -1;
     contentRead = 0;
     chunkedTransferEncoding = false;
-    lastChunkRead = false;
-    currentChunkRead = 0;
+    chunkState = ChunkState::Size;
     currentChunkSize = 0;
+    chunkLineSize = 0;
+    trailerSize = 0;
     upgrade = false;
+    keepAlive = true;
+    bodyModeChosen = false;
+    maxBodySize = 0;
+    error = Error::None;
 
-    fragment.clear();
-    bodyBuffer.clear();
     body.clear();
+    bodyDevice.reset();
 }
 
-// The body reading functions were mostly copied from QHttpNetworkReplyPrivate
+/*!
+    \internal
+
+    Reads up to \a size bytes of the body from \a socket straight into the
+    body device if the body is streamed, and into body otherwise.
+
+    Returns the number of bytes read, or -1 if the socket could not be read.
+*/
+qint64 QHttpServerRequestPrivate::readBodyData(QIODevice *socket, qint64 size)
+{
+    if (bodyDevice) {
+        QByteArray data(size, Qt::Uninitialized);
+        const qint64 haveRead = socket->read(data.data(), size);
+        if (haveRead > 0) {
+            data.truncate(haveRead);
+            bodyDevice->append(std::move(data));
+        }
+        return haveRead;
+    }
+
+    // Within the reserved capacity, resizing does not reallocate
+    const qsizetype offset = body.size();
+    body.resize(offset + size);
+    const qint64 haveRead = socket->read(body.data() + offset, size);
+    body.truncate(offset + qMax(haveRead, qint64(0)));
+    return haveRead;
+}
 
 /*!
     \internal
+
+    Appends \a data, which was peeked from the socket, to the body.
+*/
+void QHttpServerRequestPrivate::appendBodyData(QByteArrayView data)
+{
+    if (bodyDevice)
+        bodyDevice->append(data.toByteArray());
+    else
+        body.append(data);
+}
+
+/*!
+    \internal
+
+    Reads the body of known length. Unless the body is streamed, it is read
+    straight into body, which is allocated once for the whole body.
 */
 // note this function can only be used for non-chunked, non-compressed with
 // known content length
 qsizetype QHttpServerRequestPrivate::readBodyFast(QIODevice *socket)
 {
+    // The client claims the length, so memory is only reserved up to this
+    // size before the data arrives
+    constexpr qsizetype MaxPreallocation = 16 * 1024 * 1024;
 
     qsizetype toBeRead = qMin(socket->bytesAvailable(), bodyLength - contentRead);
     if (!toBeRead)
         return 0;
 
-    QByteArray bd;
-    bd.resize(toBeRead);
-    qsizetype haveRead = socket->read(bd.data(), toBeRead);
-    if (haveRead == -1) {
-        bd.clear();
-        return 0; // ### error checking here;
-    }
-    bd.resize(haveRead);
+    if (!bodyDevice && contentRead == 0)
+        body.reserve(qMin(bodyLength, MaxPreallocation));
 
-    bodyBuffer.append(bd);
+    const qint64 haveRead = readBodyData(socket, toBeRead);
+    if (haveRead == -1)
+        return -1;
 
     contentRead += haveRead;
 
@@ -386,137 +672,185 @@ qsizetype QHttpServerRequestPrivate::readBodyFast(QIODevice *socket)
 
 /*!
     \internal
+
+    Decodes as much of the chunked body as \a socket has. The decoder keeps
+    its state between calls, so the body may arrive split anywhere, even
+    within a CRLF.
+
+    The framing and the data of small chunks are decoded from one peeked
+    span, which is then skipped. The data of large chunks is read straight
+    into the body.
+
+    Returns the number of bytes consumed, or -1 if the body is malformed or
+    exceeds a limit.
 */
-qsizetype QHttpServerRequestPrivate::readRequestBodyRaw(QIODevice *socket, qsizetype size)
+qsizetype QHttpServerRequestPrivate::readRequestBodyChunked(QIODevice *socket)
 {
-    // FIXME get rid of this function and just use readBodyFast and give it socket->bytesAvailable()
+    // Large enough for many small chunks with their framing
+    constexpr qint64 SpanSize = 4096;
+
     qsizetype bytes = 0;
-    Q_ASSERT(socket);
-
-    int toBeRead = qMin<qsizetype>(128 * 1024, qMin<qint64>(size, socket->bytesAvailable()));
-
-    while (toBeRead > 0) {
-        QByteArray byteData;
-        byteData.resize(toBeRead);
-        qsizetype haveRead = socket->read(byteData.data(), byteData.size());
-        if (haveRead <= 0) {
-            // ### error checking here
-            byteData.clear();
-            return bytes;
+    while (state == State::ReadingData) {
+        qint64 consumed;
+        if (chunkState == ChunkState::Data && currentChunkSize >= SpanSize) {
+            consumed = readBodyData(socket,
+                                    qMin(socket->bytesAvailable(), qint64(currentChunkSize)));
+            if (consumed > 0) {
+                currentChunkSize -= consumed;
+                contentRead += consumed;
+                if (currentChunkSize == 0)
+                    chunkState = ChunkState::DataCr;
+            }
+        } else {
+            char span[SpanSize];
+            consumed = socket->peek(span, SpanSize);
+            if (consumed > 0) {
+                consumed = decodeChunks(QByteArrayView(span, consumed));
+                if (consumed > 0 && socket->skip(consumed) != consumed)
+                    return -1;
+            }
         }
 
-        byteData.resize(haveRead);
-        bodyBuffer.append(byteData);
-        bytes += haveRead;
-        size -= haveRead;
-
-        toBeRead = qMin<qsizetype>(128 * 1024, qMin<qsizetype>(size, socket->bytesAvailable()));
+        if (consumed < 0)
+            return -1;
+        if (consumed == 0)
+            break;
+        bytes += consumed;
     }
     return bytes;
 }
 
 /*!
     \internal
+
+    Runs the chunked body decoder over \a span, stopping at the end of the
+    body. Chunk extensions are skipped, and trailer fields are skipped
+    within the limit of the header size, as they must not be merged into
+    the header fields blindly.
+
+    Returns the number of bytes of \a span that were decoded, or -1 on
+    error.
 */
-qsizetype QHttpServerRequestPrivate::readRequestBodyChunked(QIODevice *socket)
+qsizetype QHttpServerRequestPrivate::decodeChunks(QByteArrayView span)
 {
-    qsizetype bytes = 0;
-    while (socket->bytesAvailable()) {
-        if (!lastChunkRead && currentChunkRead >= currentChunkSize) {
-            // For the first chunk and when we're done with a chunk
-            currentChunkSize = 0;
-            currentChunkRead = 0;
-            if (bytes) {
-                // After a chunk
-                char crlf[2];
-                // read the "\r\n" after the chunk
-                qsizetype haveRead = socket->read(crlf, 2);
-                // FIXME: This code is slightly broken and not optimal. What if the 2 bytes are not
-                // available yet?! For nice reasons (the toLong in getChunkSize accepting \n at the
-                // beginning it right now still works, but we should definitely fix this.
-
-                if (haveRead != 2)
-                    return bytes;
-                bytes += haveRead;
-            }
-            // Note that chunk size gets stored in currentChunkSize, what is returned is the bytes
-            // read
-            bytes += getChunkSize(socket, &currentChunkSize);
-            if (currentChunkSize == -1)
-                break;
+    const auto fail = [this](Error reason) {
+        error = reason;
+        return -1;
+    };
+
+    qsizetype i = 0;
+    while (i < span.size() && state == State::ReadingData) {
+        if (chunkState == ChunkState::Data) {
+            const qsizetype size = qMin(span.size() - i, currentChunkSize);
+            appendBodyData(span.sliced(i, size));
+            i += size;
+            currentChunkSize -= size;
+            contentRead += size;
+            if (currentChunkSize == 0)
+                chunkState = ChunkState::DataCr;
+            continue;
         }
-        // if the chunk size is 0, end of the stream
-        if (currentChunkSize == 0 || lastChunkRead) {
-            lastChunkRead = true;
-            // try to read the "\r\n" after the chunk
-            char crlf[2];
-            qsizetype haveRead = socket->read(crlf, 2);
-            if (haveRead > 0)
-                bytes += haveRead;
-
-            if ((haveRead == 2 && crlf[0] == '\r' && crlf[1] == '\n')
-                || (haveRead == 1 && crlf[0] == '\n')) {
-                state = State::AllDone;
-            } else if (haveRead == 1 && crlf[0] == '\r') {
-                break; // Still waiting for the last \n
-            } else if (haveRead > 0) {
-                // If we read something else then CRLF, we need to close the channel.
-                // FIXME forceConnectionCloseEnabled = true;
+
+        const char c = span[i++];
+        switch (chunkState) {
+        case ChunkState::Size:
+            if (const int digit = QtMiscUtils::fromHex(c); digit != -1) {
+                if (currentChunkSize > (std::numeric_limits<qsizetype>::max() >> 4))
+                    return fail(Error::BodyTooLarge);
+                currentChunkSize = (currentChunkSize << 4) | digit;
+                ++chunkLineSize;
+                break;
+            }
+            if (chunkLineSize == 0)
+                return fail(Error::Malformed);
+            if (c == ';' || c == ' ' || c == '\t') {
+                chunkState = ChunkState::Extension;
+            } else if (c == '\r') {
+                chunkState = ChunkState::SizeLf;
+            } else if (c == '\n') {
+                if (!endChunkSizeLine())
+                    return -1;
+            } else {
+                return fail(Error::Malformed);
+            }
+            break;
+        case ChunkState::Extension:
+            if (c == '\r') {
+                chunkState = ChunkState::SizeLf;
+            } else if (c == '\n') {
+                if (!endChunkSizeLine())
+                    return -1;
+            } else if (++chunkLineSize > parser.maxHeaderFieldSize()) {
+                return fail(Error::Malformed);
+            }
+            break;
+        case ChunkState::SizeLf:
+            if (c != '\n')
+                return fail(Error::Malformed);
+            if (!endChunkSizeLine())
+                return -1;
+            break;
+        case ChunkState::DataCr:
+            if (c == '\r')
+                chunkState = ChunkState::DataLf;
+            else if (c == '\n')
+                chunkState = ChunkState::Size;
+            else
+                return fail(Error::Malformed);
+            break;
+        case ChunkState::DataLf:
+            if (c != '\n')
+                return fail(Error::Malformed);
+            chunkState = ChunkState::Size;
+            break;
+        case ChunkState::TrailerStart:
+            // An empty line ends the trailer section and the body
+            if (c == '\r') {
+                chunkState = ChunkState::TrailerEndLf;
+            } else if (c == '\n') {
                 state = State::AllDone;
+            } else {
+                chunkState = ChunkState::Trailer;
+                if (maxHeaderSize > 0 && ++trailerSize > maxHeaderSize)
+                    return fail(Error::HeaderTooLarge);
             }
             break;
+        case ChunkState::Trailer:
+            if (c == '\n') {
+                chunkState = ChunkState::TrailerStart;
+            } else if (maxHeaderSize > 0 && ++trailerSize > maxHeaderSize) {
+                return fail(Error::HeaderTooLarge);
+            }
+            break;
+        case ChunkState::TrailerEndLf:
+            if (c != '\n')
+                return fail(Error::Malformed);
+            state = State::AllDone;
+            break;
+        case ChunkState::Data:
+            Q_UNREACHABLE();
         }
-
-        // otherwise, try to begin reading this chunk / to read what is missing for this chunk
-        qsizetype haveRead = readRequestBodyRaw(socket, currentChunkSize - currentChunkRead);
-        currentChunkRead += haveRead;
-        bytes += haveRead;
-
-        // ### error checking here
     }
-    return bytes;
+    return i;
 }
 
 /*!
     \internal
+
+    Starts reading the data of the chunk whose size line just ended, or the
+    trailer section after the last chunk. Returns \c false if the chunk
+    exceeds the body size limit.
 */
-qsizetype QHttpServerRequestPrivate::getChunkSize(QIODevice *socket, qsizetype *chunkSize)
+bool QHttpServerRequestPrivate::endChunkSizeLine()
 {
-    qsizetype bytes = 0;
-    char crlf[2];
-    *chunkSize = -1;
-
-    int bytesAvailable = socket->bytesAvailable();
-    // FIXME rewrite to permanent loop without bytesAvailable
-    while (bytesAvailable > bytes) {
-        qsizetype sniffedBytes = socket->peek(crlf, 2);
-        int fragmentSize = fragment.size();
-
-        // check the next two bytes for a "\r\n", skip blank lines
-        if ((fragmentSize && sniffedBytes == 2 && crlf[0] == '\r' && crlf[1] == '\n')
-            || (fragmentSize > 1 && fragment.endsWith('\r') && crlf[0] == '\n')) {
-            bytes += socket->read(crlf, 1); // read the \r or \n
-            if (crlf[0] == '\r')
-                bytes += socket->read(crlf, 1); // read the \n
-            bool ok = false;
-            // ignore the chunk-extension
-            fragment = fragment.mid(0, fragment.indexOf(';')).trimmed();
-            *chunkSize = fragment.toLong(&ok, 16);
-            fragment.clear();
-            break; // size done
-        } else {
-            // read the fragment to the buffer
-            char c = 0;
-            qsizetype haveRead = socket->read(&c, 1);
-            if (haveRead < 0)
-                return -1;
-
-            bytes += haveRead;
-            fragment.append(c);
-        }
+    // Reject the chunk before reading it
+    if (maxBodySize > 0 && currentChunkSize > maxBodySize - contentRead) {
+        error = Error::BodyTooLarge;
+        return false;
     }
-
-    return bytes;
+    chunkLineSize = 0;
+    chunkState = currentChunkSize > 0 ? ChunkState::Data : ChunkState::TrailerStart;
+    return true;
 }
 
 /*!
@@ -576,7 +910,7 @@ QHttpServerRequest::~QHttpServerRequest()
 */
 QByteArray QHttpServerRequest::value(const QByteArray &key) const
 {
-    return d->parser.combinedHeaderValue(key);
+    return d->headerField(key);
 }
 
 /*!
@@ -608,17 +942,54 @@ QHttpServerRequest::Method QHttpServerRequest::method() const
 */
 QList<QPair<QByteArray, QByteArray>> QHttpServerRequest::headers() const
 {
-    return d->parser.headers();
+    const QByteArrayView block(d->headerBlock);
+    QList<QPair<QByteArray, QByteArray>> headers;
+    headers.reserve(d->headerFields.size());
+    for (const auto &field : d->headerFields) {
+        headers.emplace_back(block.sliced(field.nameBegin, field.nameSize).toByteArray(),
+                             block.sliced(field.valueBegin, field.valueSize).toByteArray());
+    }
+    return headers;
 }
 
 /*!
     Returns the body of the request.
+
+    The body is empty if it is streamed to bodyDevice().
 */
 QByteArray QHttpServerRequest::body() const
 {
     return d->body;
 }
 
+/*!
+    \since 6.7
+
+    Returns the device to read the body of the request from as it arrives,
+    or \nullptr if the body is read completely before the request is
+    handled.
+
+    The body is streamed for requests handled by a rule with
+    \l {QHttpServerRouterRule::setStreamingBody()}{streaming body}
+    enabled. The handler runs as soon as the request headers are read. The
+    device emits readyRead() when more of the body is available, and
+    readChannelFinished() once it is complete; atEnd() is \c true then. If
+    the connection is closed early, the device reports an errorString().
+
+    The server stops reading from the connection while the handler has
+    64 KiB of unread data, so that a client cannot send data faster than it
+    is processed.
+
+    The device belongs to the request and is deleted with it once the
+    response is sent.
+
+    \sa body()
+*/
+QIODevice *QHttpServerRequest::bodyDevice() const
+{
+    return d->bodyDevice.get();
+}
+
 /*!
     Returns the address of the origin host of the request.
 */
@@ -657,6 +1028,89 @@ quint16 QHttpServerRequest::localPort() const
     return d->localPort;
 }
 
+/*!
+    \since 6.7
+
+    Returns the value of the first header named \a key, or a null view if
+    the request has no such header. Header names are compared case
+    insensitively.
+
+    Unlike value(), this function does not allocate memory. The returned
+    view points into the buffer the request was received in, and stays
+    valid as long as this request exists.
+
+    \sa value(), headers()
+*/
+QByteArrayView QHttpServerRequest::headerView(QByteArrayView key) const
+{
+    return d->headerView(key);
+}
+
+/*!
+    \since 6.7
+
+    Returns the path of the request target, as it was received, that is,
+    without decoding percent-encoded characters.
+
+    The returned view stays valid as long as this request exists.
+
+    \sa url(), queryView()
+*/
+QByteArrayView QHttpServerRequest::pathView() const
+{
+    return QByteArrayView(d->headerBlock).sliced(d->pathBegin, d->pathSize);
+}
+
+/*!
+    \since 6.7
+
+    Returns the query of the request target, without the leading question
+    mark, as it was received, that is, without decoding percent-encoded
+    characters.
+
+    The returned view stays valid as long as this request exists.
+
+    \sa query(), pathView()
+*/
+QByteArrayView QHttpServerRequest::queryView() const
+{
+    return QByteArrayView(d->headerBlock).sliced(d->queryBegin, d->querySize);
+}
+
+/*!
+    \since 6.7
+
+    Returns \c true if the client has the current representation already,
+    that is, if this is a GET or HEAD request whose \c If-None-Match header
+    matches \a etag, or, without that header, whose \c If-Modified-Since
+    header is not older than \a lastModified.
+
+    \a etag is a quoted entity tag, as in the \c ETag header, and
+    \a lastModified is ignored if it is not valid. Handlers that can tell
+    from a version or a timestamp whether their data changed can answer
+    with \c{304 Not Modified} without building the body:
+
+    \code
+    server.route("/status", [&model](const QHttpServerRequest &request) {
+        const QByteArray etag = '"' + QByteArray::number(model.revision()) + '"';
+        if (request.isNotModified(etag)) {
+            QHttpServerResponse response(QHttpServerResponse::StatusCode::NotModified);
+            response.setHeader("ETag", etag);
+            return response;
+        }
+        QHttpServerResponse response(model.toJson());
+        response.setHeader("ETag", etag);
+        return response;
+    });
+    \endcode
+
+    \sa QHttpServerConfiguration::setConditionalRequestHandlingEnabled()
+*/
+bool QHttpServerRequest::isNotModified(QByteArrayView etag, const QDateTime &lastModified) const
+{
+    return QHttpServerConditional::isNotModified(d.get(), etag, lastModified);
+}
+
 QT_END_NAMESPACE
 
 #include "moc_qhttpserverrequest.cpp"
@@ -6,6 +6,7 @@
 
 #include <QtHttpServer/qthttpserverglobal.h>
 
+#include <QtCore/qdatetime.h>
 #include <QtCore/qglobal.h>
 #include <QtCore/qurl.h>
 #include <QtCore/qurlquery.h>
@@ -15,6 +16,7 @@
 
 QT_BEGIN_NAMESPACE
 
+class QIODevice;
 class QRegularExpression;
 class QString;
 
@@ -22,6 +24,8 @@ class QHttpServerRequestPrivate;
 class QHttpServerRequest final
 {
     friend class QHttpServerResponse;
+    friend class QHttpServerResponder;
+    friend class QHttpServerResponderPrivate;
     friend class QHttpServerStream;
 
     Q_GADGET_EXPORT(Q_HTTPSERVER_EXPORT)
@@ -54,11 +58,19 @@ public:
     Q_HTTPSERVER_EXPORT Method method() const;
     Q_HTTPSERVER_EXPORT QList<QPair<QByteArray, QByteArray>> headers() const;
     Q_HTTPSERVER_EXPORT QByteArray body() const;
+    Q_HTTPSERVER_EXPORT QIODevice *bodyDevice() const;
     Q_HTTPSERVER_EXPORT QHostAddress remoteAddress() const;
     Q_HTTPSERVER_EXPORT quint16 remotePort() const;
     Q_HTTPSERVER_EXPORT QHostAddress localAddress() const;
     Q_HTTPSERVER_EXPORT quint16 localPort() const;
 
+    Q_HTTPSERVER_EXPORT QByteArrayView headerView(QByteArrayView key) const;
+    Q_HTTPSERVER_EXPORT QByteArrayView pathView() const;
+    Q_HTTPSERVER_EXPORT QByteArrayView queryView() const;
+
+    Q_HTTPSERVER_EXPORT bool isNotModified(QByteArrayView etag,
+                                           const QDateTime &lastModified = QDateTime()) const;
+
 private:
     Q_DISABLE_COPY(QHttpServerRequest)
 
@@ -5,8 +5,12 @@
 #define QHTTPSERVERREQUEST_P_H
 
 #include <QtHttpServer/qhttpserverrequest.h>
+
 #include <QtNetwork/private/qhttpheaderparser_p.h>
-#include <QtCore/private/qbytedata_p.h>
+#include <private/qhttpserverheaderscanner_p.h>
+#include <private/qhttpserverrequestbody_p.h>
+
+#include <memory>
 
 //
 //  W A R N I N G
@@ -37,26 +41,42 @@ public:
         AllDone,
     } state = State::NothingDone;
 
+    // Why parse() failed
+    enum class Error {
+        None,
+        Malformed,
+        RequestLineTooLong,
+        HeaderTooLarge,
+        BodyTooLarge,
+    } error = Error::None;
+
     QUrl url;
     QHttpServerRequest::Method method;
     QHttpHeaderParser parser;
 
+    void setTargetOffsets(qsizetype offset, QByteArrayView target);
     bool parseRequestLine(QByteArrayView line);
+    qsizetype peekHeaderBlock(QIODevice *socket, qsizetype limit);
+    qsizetype consumeHeaderBlock(QIODevice *socket, qsizetype offset, qsizetype size);
+    qsizetype findHeaderEnd(qsizetype from) const;
+    bool parseHeaders(qsizetype headersEnd);
     qsizetype readRequestLine(QIODevice *socket);
     qsizetype readHeader(QIODevice *socket);
     qsizetype sendContinue(QIODevice *socket);
+    qint64 readBodyData(QIODevice *socket, qint64 size);
+    void appendBodyData(QByteArrayView data);
     qsizetype readBodyFast(QIODevice *socket);
-    qsizetype readRequestBodyRaw(QIODevice *socket, qsizetype size);
     qsizetype readRequestBodyChunked(QIODevice *socket);
-    qsizetype getChunkSize(QIODevice *socket, qsizetype *chunkSize);
+    qsizetype decodeChunks(QByteArrayView span);
+    bool endChunkSizeLine();
 
     bool parse(QIODevice *socket);
 
     void clear();
 
     qint64 contentLength() const;
-    QByteArray headerField(const QByteArray &name) const
-    { return parser.combinedHeaderValue(name); }
+    QByteArrayView headerView(QByteArrayView name) const;
+    QByteArray headerField(QByteArrayView name) const;
 
     QHostAddress remoteAddress;
     quint16 remotePort;
@@ -66,14 +86,52 @@ public:
     qsizetype bodyLength;
     qsizetype contentRead;
     bool chunkedTransferEncoding;
-    bool lastChunkRead;
-    qsizetype currentChunkRead;
+
+    // Where the chunked body decoder is, it resumes there with the next
+    // data from the socket
+    enum class ChunkState {
+        Size,
+        Extension,
+        SizeLf,
+        Data,
+        DataCr,
+        DataLf,
+        TrailerStart,
+        Trailer,
+        TrailerEndLf,
+    } chunkState = ChunkState::Size;
+    // The size of the current chunk while reading the size line, the
+    // bytes left of it while reading the data
     qsizetype currentChunkSize;
+    qsizetype chunkLineSize;
+    qsizetype trailerSize;
     bool upgrade;
+    bool keepAlive = true;
+    // Set once the stream chose how the body is read, when the header
+    // block is complete
+    bool bodyModeChosen = false;
+
+    // Limits set by the stream, zero means no limit. The body limit depends
+    // on the handler and is set along with the body mode.
+    qsizetype maxRequestLineSize = 0;
+    qsizetype maxHeaderSize = 0;
+    qsizetype maxHeaderCount = 0;
+    qint64 maxBodySize = 0;
+
+    // The request line followed by the header block. The header fields and
+    // the URL views point into it.
+    QByteArray headerBlock;
+    qsizetype headersBegin = 0;
+    qsizetype pathBegin = 0;
+    qsizetype pathSize = 0;
+    qsizetype queryBegin = 0;
+    qsizetype querySize = 0;
+    QHttpServerHeaderScanner::Fields headerFields;
 
-    QByteArray fragment;
-    QByteDataBuffer bodyBuffer;
     QByteArray body;
+    // Receives the body instead of body if the request is handled before
+    // its body is read
+    std::unique_ptr<QHttpServerRequestBody> bodyDevice;
 };
 
 QT_END_NAMESPACE
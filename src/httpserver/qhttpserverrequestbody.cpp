@@ -0,0 +1,132 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "qhttpserverrequestbody_p.h"
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \internal
+
+    Creates an open, empty body. \a drained is called when the handler
+    has read enough of a full buffer for reading from the socket to
+    continue.
+*/
+QHttpServerRequestBody::QHttpServerRequestBody(std::function<void()> drained)
+    : drained(std::move(drained))
+{
+    // The data is buffered here, there is no need for QIODevice to copy it
+    // once more.
+    open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+}
+
+/*!
+    \internal
+*/
+QHttpServerRequestBody::~QHttpServerRequestBody() = default;
+
+/*!
+    \internal
+*/
+bool QHttpServerRequestBody::atEnd() const
+{
+    return finished && buffer.isEmpty();
+}
+
+/*!
+    \internal
+*/
+qint64 QHttpServerRequestBody::bytesAvailable() const
+{
+    return buffer.byteAmount() + QIODevice::bytesAvailable();
+}
+
+/*!
+    \internal
+
+    Moves \a data to the end of the body. The reader is notified by
+    notifyReadyRead(), once for all the data that one socket read brought.
+*/
+void QHttpServerRequestBody::append(QByteArray &&data)
+{
+    if (data.isEmpty())
+        return;
+    buffer.append(std::move(data));
+    hasNewData = true;
+}
+
+/*!
+    \internal
+
+    Emits readyRead() if data was appended since the last call.
+*/
+void QHttpServerRequestBody::notifyReadyRead()
+{
+    if (!std::exchange(hasNewData, false))
+        return;
+    emit readyRead();
+}
+
+/*!
+    \internal
+
+    Marks the body as complete.
+*/
+void QHttpServerRequestBody::finish()
+{
+    finished = true;
+    emit readChannelFinished();
+}
+
+/*!
+    \internal
+
+    Marks the body as incomplete, because the connection was closed before
+    all of it arrived.
+*/
+void QHttpServerRequestBody::abort()
+{
+    if (finished)
+        return;
+    setErrorString(tr("Connection closed before the request body was complete"));
+    finish();
+}
+
+/*!
+    \internal
+
+    Marks the body as incomplete, because it exceeds the size limit of the
+    route.
+*/
+void QHttpServerRequestBody::reject()
+{
+    if (finished)
+        return;
+    setErrorString(tr("Request body exceeds the size limit"));
+    finish();
+}
+
+/*!
+    \internal
+*/
+qint64 QHttpServerRequestBody::readData(char *data, qint64 maxSize)
+{
+    if (buffer.isEmpty())
+        return finished ? -1 : 0;
+
+    const bool wasFull = isFull();
+    const qint64 read = buffer.read(data, maxSize);
+    if (wasFull && !isFull() && drained)
+        drained();
+    return read;
+}
+
+/*!
+    \internal
+*/
+qint64 QHttpServerRequestBody::writeData(const char *, qint64)
+{
+    return -1;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,64 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef QHTTPSERVERREQUESTBODY_P_H
+#define QHTTPSERVERREQUESTBODY_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists for the convenience
+// of QHttpServer. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+
+#include <QtHttpServer/qthttpserverglobal.h>
+
+#include <QtCore/qiodevice.h>
+#include <QtCore/private/qbytedata_p.h>
+
+#include <functional>
+
+QT_BEGIN_NAMESPACE
+
+// The body of a request whose rule asked for it to be streamed. The stream
+// appends the data as it arrives, and stops reading from the socket while
+// BufferLimit bytes are waiting to be read by the handler.
+class QHttpServerRequestBody : public QIODevice
+{
+public:
+    static constexpr qint64 BufferLimit = 64 * 1024;
+
+    explicit QHttpServerRequestBody(std::function<void()> drained);
+    ~QHttpServerRequestBody() override;
+
+    bool isSequential() const override { return true; }
+    bool atEnd() const override;
+    qint64 bytesAvailable() const override;
+
+    bool isFull() const { return buffer.byteAmount() >= BufferLimit; }
+    bool isFinished() const { return finished; }
+
+    void append(QByteArray &&data);
+    void notifyReadyRead();
+    void finish();
+    void abort();
+    void reject();
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+    qint64 writeData(const char *data, qint64 size) override;
+
+private:
+    QByteDataBuffer buffer;
+    // Called when the buffer is no longer full
+    std::function<void()> drained;
+    bool finished = false;
+    bool hasNewData = false;
+};
+
+QT_END_NAMESPACE
+
+#endif // QHTTPSERVERREQUESTBODY_P_H
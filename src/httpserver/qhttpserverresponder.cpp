@@ -5,16 +5,31 @@
 #include <QtHttpServer/qhttpserverrequest.h>
 #include <QtHttpServer/qhttpserverresponse.h>
 #include <private/qhttpserverresponder_p.h>
+#include <private/qhttpserverconditional_p.h>
+#include <private/qhttpserverhttpdate_p.h>
 #include <private/qhttpserverliterals_p.h>
+#include <private/qhttpserverrange_p.h>
 #include <private/qhttpserverrequest_p.h>
 #include <private/qhttpserverresponse_p.h>
 #include <private/qhttpserverstream_p.h>
+#include <QtCore/qbuffer.h>
+#include <QtCore/qdatetime.h>
+#include <QtCore/qfile.h>
 #include <QtCore/qjsondocument.h>
 #include <QtCore/qloggingcategory.h>
-#include <QtCore/qtimer.h>
+#include <QtCore/qsocketnotifier.h>
+#include <QtCore/private/qtools_p.h>
+#include <QtCore/qtimezone.h>
 #include <QtNetwork/qtcpsocket.h>
-#include <map>
+#include <array>
+#include <chrono>
 #include <memory>
+#include <utility>
+
+#if defined(Q_OS_LINUX)
+#include <errno.h>
+#include <sys/sendfile.h>
+#endif
 
 QT_BEGIN_NAMESPACE
 
@@ -120,165 +135,608 @@ static const QLoggingCategory &rspLc()
 }
 
 // https://www.w3.org/Protocols/rfc2616/rfc2616-sec10.html
-static const std::map<QHttpServerResponder::StatusCode, QByteArray> statusString{
-#define XX(name, string) { QHttpServerResponder::StatusCode::name, QByteArrayLiteral(string) }
-    XX(Continue, "Continue"),
-    XX(SwitchingProtocols, "Switching Protocols"),
-    XX(Processing, "Processing"),
-    XX(Ok, "OK"),
-    XX(Created, "Created"),
-    XX(Accepted, "Accepted"),
-    XX(NonAuthoritativeInformation, "Non-Authoritative Information"),
-    XX(NoContent, "No Content"),
-    XX(ResetContent, "Reset Content"),
-    XX(PartialContent, "Partial Content"),
-    XX(MultiStatus, "Multi-Status"),
-    XX(AlreadyReported, "Already Reported"),
-    XX(IMUsed, "I'm Used"),
-    XX(MultipleChoices, "Multiple Choices"),
-    XX(MovedPermanently, "Moved Permanently"),
-    XX(Found, "Found"),
-    XX(SeeOther, "See Other"),
-    XX(NotModified, "Not Modified"),
-    XX(UseProxy, "Use Proxy"),
-    XX(TemporaryRedirect, "Temporary Redirect"),
-    XX(PermanentRedirect, "Permanent Redirect"),
-    XX(BadRequest, "Bad Request"),
-    XX(Unauthorized, "Unauthorized"),
-    XX(PaymentRequired, "Payment Required"),
-    XX(Forbidden, "Forbidden"),
-    XX(NotFound, "Not Found"),
-    XX(MethodNotAllowed, "Method Not Allowed"),
-    XX(NotAcceptable, "Not Acceptable"),
-    XX(ProxyAuthenticationRequired, "Proxy Authentication Required"),
-    XX(RequestTimeout, "Request Timeout"),
-    XX(Conflict, "Conflict"),
-    XX(Gone, "Gone"),
-    XX(LengthRequired, "Length Required"),
-    XX(PreconditionFailed, "Precondition Failed"),
-    XX(PayloadTooLarge, "Request Entity Too Large"),
-    XX(UriTooLong, "Request-URI Too Long"),
-    XX(UnsupportedMediaType, "Unsupported Media Type"),
-    XX(RequestRangeNotSatisfiable, "Requested Range Not Satisfiable"),
-    XX(ExpectationFailed, "Expectation Failed"),
-    XX(ImATeapot, "I'm a teapot"),
-    XX(MisdirectedRequest, "Misdirected Request"),
-    XX(UnprocessableEntity, "Unprocessable Entity"),
-    XX(Locked, "Locked"),
-    XX(FailedDependency, "Failed Dependency"),
-    XX(UpgradeRequired, "Upgrade Required"),
-    XX(PreconditionRequired, "Precondition Required"),
-    XX(TooManyRequests, "Too Many Requests"),
-    XX(RequestHeaderFieldsTooLarge, "Request Header Fields Too Large"),
-    XX(UnavailableForLegalReasons, "Unavailable For Legal Reasons"),
-    XX(InternalServerError, "Internal Server Error"),
-    XX(NotImplemented, "Not Implemented"),
-    XX(BadGateway, "Bad Gateway"),
-    XX(ServiceUnavailable, "Service Unavailable"),
-    XX(GatewayTimeout, "Gateway Timeout"),
-    XX(HttpVersionNotSupported, "HTTP Version Not Supported"),
-    XX(VariantAlsoNegotiates, "Variant Also Negotiates"),
-    XX(InsufficientStorage, "Insufficient Storage"),
-    XX(LoopDetected, "Loop Detected"),
-    XX(NotExtended, "Not Extended"),
-    XX(NetworkAuthenticationRequired, "Network Authentication Required"),
-    XX(NetworkConnectTimeoutError, "Network Connect Timeout Error"),
+#define QT_HTTPSERVER_STATUS_CODES(XX) \
+    XX(100, Continue, "Continue") \
+    XX(101, SwitchingProtocols, "Switching Protocols") \
+    XX(102, Processing, "Processing") \
+    XX(200, Ok, "OK") \
+    XX(201, Created, "Created") \
+    XX(202, Accepted, "Accepted") \
+    XX(203, NonAuthoritativeInformation, "Non-Authoritative Information") \
+    XX(204, NoContent, "No Content") \
+    XX(205, ResetContent, "Reset Content") \
+    XX(206, PartialContent, "Partial Content") \
+    XX(207, MultiStatus, "Multi-Status") \
+    XX(208, AlreadyReported, "Already Reported") \
+    XX(226, IMUsed, "I'm Used") \
+    XX(300, MultipleChoices, "Multiple Choices") \
+    XX(301, MovedPermanently, "Moved Permanently") \
+    XX(302, Found, "Found") \
+    XX(303, SeeOther, "See Other") \
+    XX(304, NotModified, "Not Modified") \
+    XX(305, UseProxy, "Use Proxy") \
+    XX(307, TemporaryRedirect, "Temporary Redirect") \
+    XX(308, PermanentRedirect, "Permanent Redirect") \
+    XX(400, BadRequest, "Bad Request") \
+    XX(401, Unauthorized, "Unauthorized") \
+    XX(402, PaymentRequired, "Payment Required") \
+    XX(403, Forbidden, "Forbidden") \
+    XX(404, NotFound, "Not Found") \
+    XX(405, MethodNotAllowed, "Method Not Allowed") \
+    XX(406, NotAcceptable, "Not Acceptable") \
+    XX(407, ProxyAuthenticationRequired, "Proxy Authentication Required") \
+    XX(408, RequestTimeout, "Request Timeout") \
+    XX(409, Conflict, "Conflict") \
+    XX(410, Gone, "Gone") \
+    XX(411, LengthRequired, "Length Required") \
+    XX(412, PreconditionFailed, "Precondition Failed") \
+    XX(413, PayloadTooLarge, "Request Entity Too Large") \
+    XX(414, UriTooLong, "Request-URI Too Long") \
+    XX(415, UnsupportedMediaType, "Unsupported Media Type") \
+    XX(416, RequestRangeNotSatisfiable, "Requested Range Not Satisfiable") \
+    XX(417, ExpectationFailed, "Expectation Failed") \
+    XX(418, ImATeapot, "I'm a teapot") \
+    XX(421, MisdirectedRequest, "Misdirected Request") \
+    XX(422, UnprocessableEntity, "Unprocessable Entity") \
+    XX(423, Locked, "Locked") \
+    XX(424, FailedDependency, "Failed Dependency") \
+    XX(426, UpgradeRequired, "Upgrade Required") \
+    XX(428, PreconditionRequired, "Precondition Required") \
+    XX(429, TooManyRequests, "Too Many Requests") \
+    XX(431, RequestHeaderFieldsTooLarge, "Request Header Fields Too Large") \
+    XX(451, UnavailableForLegalReasons, "Unavailable For Legal Reasons") \
+    XX(500, InternalServerError, "Internal Server Error") \
+    XX(501, NotImplemented, "Not Implemented") \
+    XX(502, BadGateway, "Bad Gateway") \
+    XX(503, ServiceUnavailable, "Service Unavailable") \
+    XX(504, GatewayTimeout, "Gateway Timeout") \
+    XX(505, HttpVersionNotSupported, "HTTP Version Not Supported") \
+    XX(506, VariantAlsoNegotiates, "Variant Also Negotiates") \
+    XX(507, InsufficientStorage, "Insufficient Storage") \
+    XX(508, LoopDetected, "Loop Detected") \
+    XX(510, NotExtended, "Not Extended") \
+    XX(511, NetworkAuthenticationRequired, "Network Authentication Required") \
+    XX(599, NetworkConnectTimeoutError, "Network Connect Timeout Error")
+
+// Complete status lines, indexed by the status code minus 100, so that
+// writeStatusLine() appends a single precomputed string.
+static constexpr qsizetype FirstStatusCode = 100;
+static constexpr qsizetype LastStatusCode = 599;
+
+static constexpr auto statusLines = [] {
+    std::array<QByteArrayView, LastStatusCode - FirstStatusCode + 1> lines = {};
+#define XX(code, name, string) \
+    static_assert(int(QHttpServerResponder::StatusCode::name) == code); \
+    lines[code - FirstStatusCode] = QByteArrayView("HTTP/1.1 " #code " " string "\r\n");
+    QT_HTTPSERVER_STATUS_CODES(XX)
 #undef XX
-};
+    return lines;
+}();
+
+#undef QT_HTTPSERVER_STATUS_CODES
+
+// Returns the current time as an IMF-fixdate (RFC 7231, section 7.1.1.1).
+// The value only changes once per second, so each thread formats it at
+// most once per second and hands out the cached string otherwise.
+static QByteArray currentHttpDate()
+{
+    struct Cache
+    {
+        qint64 second = -1;
+        QByteArray value;
+    };
+    thread_local Cache cache;
+
+    using namespace std::chrono;
+    const qint64 now = duration_cast<seconds>(system_clock::now().time_since_epoch()).count();
+    if (now != cache.second) {
+        cache.second = now;
+        cache.value = QHttpServerHttpDate::toString(
+                QDateTime::fromSecsSinceEpoch(now, QTimeZone::UTC));
+    }
+    return cache.value;
+}
+
+/*!
+    \internal
+
+    Adds the Date and Server headers of the server configuration and the
+    Connection header of the stream that were not written by the handler.
+*/
+void QHttpServerResponderPrivate::writeDefaultHeaders()
+{
+    if (defaultHeaders & DateHeader) {
+        head += "Date: ";
+        head += currentHttpDate();
+        head += "\r\n";
+    }
+    if (defaultHeaders & ServerHeader) {
+        head += "Server: ";
+        head += stream->configuration.serverHeader();
+        head += "\r\n";
+    }
+    if (defaultHeaders & ConnectionHeader) {
+        head += "Connection: ";
+        head += exchange->connectionHeader;
+        head += "\r\n";
+    }
+    defaultHeaders = 0;
+}
+
+/*!
+    \internal
+
+    Turns \a response into \c{304 Not Modified} if conditional request
+    handling is enabled and the validators of the request match it. Adds
+    the validators that \a response lacks.
+
+    \sa QHttpServerConfiguration::setConditionalRequestHandlingEnabled()
+*/
+void QHttpServerResponderPrivate::evaluateConditions(QHttpServerResponsePrivate *response) const
+{
+    if (stream->configuration.isConditionalRequestHandlingEnabled())
+        QHttpServerConditional::evaluate(response, exchange->request->d.get());
+    // Also for 304 responses of handlers
+    if (response->statusCode == QHttpServerResponder::StatusCode::NotModified)
+        QHttpServerConditional::makeNotModified(response);
+}
 
 /*!
     \internal
+
+    Returns \c true if the request is a GET request with a Range header.
+*/
+bool QHttpServerResponderPrivate::requestsRanges() const
+{
+    const QHttpServerRequestPrivate *request = exchange->request->d.get();
+    return request->method == QHttpServerRequest::Method::Get
+            && !request->headerView("range").isNull();
+}
+
+/*!
+    \internal
+
+    Answers a request for byte ranges of \a device, which holds the whole
+    representation, with \c{206 Partial Content} or \c{416 Range Not
+    Satisfiable}. \a headers are the headers of the response for the whole
+    representation. Only the requested bytes
+    are read from \a device.
+
+    Returns \c false, leaving \a device untouched, if the whole
+    representation is to be sent instead. That is the case for invalid
+    Range headers and when an If-Range header does not match.
+*/
+bool QHttpServerResponderPrivate::writeRanges(
+        QHttpServerResponder *q, std::unique_ptr<QIODevice, QScopedPointerDeleteLater> &device,
+        const std::vector<std::pair<QByteArray, QByteArray>> &headers)
+{
+    using namespace QHttpServerRange;
+
+    if (device->isSequential() || !requestsRanges())
+        return false;
+
+    QByteArray contentType;
+    QByteArrayView etag;
+    QByteArrayView lastModified;
+    for (const auto &header : headers) {
+        if (header.first.compare(QHttpServerLiterals::contentTypeHeader(), Qt::CaseInsensitive) == 0)
+            contentType = header.second;
+        else if (header.first.compare(QHttpServerLiterals::etagHeader(), Qt::CaseInsensitive) == 0)
+            etag = header.second;
+        else if (header.first.compare(QHttpServerLiterals::lastModifiedHeader(),
+                                      Qt::CaseInsensitive) == 0)
+            lastModified = header.second;
+    }
+
+    const QHttpServerRequestPrivate *request = exchange->request->d.get();
+    const QByteArrayView ifRange = request->headerView("if-range");
+    if (!ifRange.isNull() && !ifRangeMatches(ifRange, etag, lastModified))
+        return false;
+
+    const qint64 size = device->size();
+    QList<Range> ranges;
+    const Result result = parse(request->headerView("range"), size, &ranges);
+    if (result == Result::Ignored)
+        return false;
+    const bool multipart = ranges.size() > 1;
+    if (result == Result::Satisfiable && !multipart && !device->seek(ranges.first().first))
+        return false;
+
+    q->writeStatusLine(result == Result::Satisfiable
+                               ? QHttpServerResponder::StatusCode::PartialContent
+                               : QHttpServerResponder::StatusCode::RequestRangeNotSatisfiable);
+    for (const auto &header : headers) {
+        if (header.first.compare(QHttpServerLiterals::contentLengthHeader(),
+                                 Qt::CaseInsensitive) == 0) {
+            continue;
+        }
+        const bool isContentType = header.first.compare(QHttpServerLiterals::contentTypeHeader(),
+                                                        Qt::CaseInsensitive) == 0;
+        if (!isContentType || (result == Result::Satisfiable && !multipart))
+            q->writeHeader(header.first, header.second);
+    }
+
+    if (result == Result::Unsatisfiable) {
+        q->writeHeader(QHttpServerLiterals::contentRangeHeader(),
+                       "bytes */" + QByteArray::number(size));
+        q->writeHeader(QHttpServerLiterals::contentLengthHeader(), QByteArray("0"));
+        q->writeBody(nullptr, 0);
+        return true;
+    }
+
+    exchange->chunkedBody = false;
+    if (!multipart) {
+        const Range &range = ranges.first();
+        q->writeHeader(QHttpServerLiterals::contentRangeHeader(), contentRange(range, size));
+        q->writeHeader(QHttpServerLiterals::contentLengthHeader(),
+                       QByteArray::number(range.size()));
+        q->writeBody(nullptr, 0);
+        exchange->bodyLength = range.size();
+        stream->write(exchange, device.release());
+        return true;
+    }
+
+    auto body = std::make_unique<QHttpServerRangeDevice>(device.release(), ranges, contentType);
+    q->writeHeader(QHttpServerLiterals::contentTypeHeader(),
+                   "multipart/byteranges; boundary=" + body->boundary());
+    q->writeHeader(QHttpServerLiterals::contentLengthHeader(), QByteArray::number(body->size()));
+    q->writeBody(nullptr, 0);
+    stream->write(exchange, body.release());
+    return true;
+}
+
+/*!
+    \internal
+
+    Pumps the body of a response from a device to the socket.
+
+    The data is read into one of two buffers and handed to the socket as a
+    QByteArray, which the socket queues without copying. The next read goes
+    into the other buffer, while the socket still sends the first one. The
+    read size starts at 64 KiB, grows while the source fills the buffer,
+    and shrinks when it delivers less, up to the transfer buffer size of
+    the configuration.
+
+    Reading stops once the socket has more than two buffers' worth of data
+    to write, and resumes once it is down to half a buffer. If a length is
+    given, the transfer ends after that many bytes. Otherwise, it ends at
+    the end of a random-access source, while a sequential source may still
+    produce data until it emits readChannelFinished() or is closed.
 */
-template <qint64 BUFFERSIZE = 512>
 struct IOChunkedTransfer
 {
-    // TODO This is not the fastest implementation, as it does read & write
-    // in a sequential fashion, but these operation could potentially overlap.
-    // TODO Can we implement it without the buffer? Direct write to the target buffer
-    // would be great.
-
-    const qint64 bufferSize = BUFFERSIZE;
-    char buffer[BUFFERSIZE];
-    qint64 beginIndex = -1;
-    qint64 endIndex = -1;
+    static constexpr qsizetype MinBufferSize = 64 * 1024;
+    // With chunked framing, the size line goes in front of the data and the
+    // CRLF after it, so that each chunk is a single QByteArray. The size is
+    // padded with zeros to a fixed width, which fits any buffer size.
+    static constexpr qsizetype ChunkSizeDigits = 8;
+    static constexpr qsizetype ChunkHeaderSize = ChunkSizeDigits + 2;
+    static constexpr qsizetype ChunkTrailerSize = 2;
+
+    QByteArray buffers[2];
+    int nextBuffer = 0;
+    qsizetype bufferSize;
+    const qsizetype maxBufferSize;
+    // Bytes left to send, -1 to send until the end of the source
+    qint64 remaining;
     QPointer<QIODevice> source;
     const QPointer<QIODevice> sink;
     const QMetaObject::Connection bytesWrittenConnection;
     const QMetaObject::Connection readyReadConnection;
-    IOChunkedTransfer(QIODevice *input, QIODevice *output) :
+    const QMetaObject::Connection readChannelFinishedConnection;
+    const QMetaObject::Connection aboutToCloseConnection;
+    // Called once the source is consumed, or the sink is gone
+    const std::function<void()> finished;
+    const bool chunked;
+    // No more data will arrive from a sequential source
+    bool sourceFinished;
+    bool done = false;
+
+    IOChunkedTransfer(QIODevice *input, QIODevice *output, bool chunked, qint64 length,
+                      bool inputFinished, qsizetype maxBufferSize,
+                      std::function<void()> finished) :
+        bufferSize(qMin(MinBufferSize, maxBufferSize)),
+        maxBufferSize(maxBufferSize),
+        remaining(length),
         source(input),
         sink(output),
         bytesWrittenConnection(QObject::connect(sink.data(), &QIODevice::bytesWritten, sink.data(), [this]() {
-              writeToOutput();
+            if (sink->bytesToWrite() <= lowWatermark())
+                pump();
         })),
         readyReadConnection(QObject::connect(source.data(), &QIODevice::readyRead, source.data(), [this]() {
-            readFromInput();
-        }))
+            pump();
+        })),
+        readChannelFinishedConnection(QObject::connect(source.data(), &QIODevice::readChannelFinished, source.data(), [this]() {
+            sourceFinished = true;
+            pump();
+        })),
+        // Whatever is buffered can still be read while the source closes
+        aboutToCloseConnection(QObject::connect(source.data(), &QIODevice::aboutToClose, source.data(), [this]() {
+            sourceFinished = true;
+            pump();
+        })),
+        finished(std::move(finished)),
+        chunked(chunked),
+        sourceFinished(inputFinished)
     {
-        Q_ASSERT(!source->atEnd());  // TODO error out
         QObject::connect(sink.data(), &QObject::destroyed, source.data(), &QObject::deleteLater);
         QObject::connect(source.data(), &QObject::destroyed, source.data(), [this]() {
             delete this;
         });
-        readFromInput();
+        pump();
     }
 
     ~IOChunkedTransfer()
     {
         QObject::disconnect(bytesWrittenConnection);
         QObject::disconnect(readyReadConnection);
+        QObject::disconnect(readChannelFinishedConnection);
+        QObject::disconnect(aboutToCloseConnection);
+        if (finished)
+            finished();
     }
 
-    inline bool isBufferEmpty()
+    qint64 highWatermark() const { return 2 * bufferSize; }
+    qint64 lowWatermark() const { return bufferSize / 2; }
+
+    void pump()
     {
-        Q_ASSERT(beginIndex <= endIndex);
-        return beginIndex == endIndex;
+        while (!done && sink && sink->bytesToWrite() < highWatermark()) {
+            if (remaining == 0 || !source->isOpen()) {
+                finish();
+                return;
+            }
+
+            QByteArray &buffer = buffers[nextBuffer];
+            // Still queued in the socket from two reads ago
+            if (!buffer.isDetached())
+                buffer = QByteArray();
+
+            const qsizetype headerSize = chunked ? ChunkHeaderSize : 0;
+            const qsizetype trailerSize = chunked ? ChunkTrailerSize : 0;
+            // Within the capacity of a reused buffer, this does not reallocate
+            buffer.resize(headerSize + bufferSize + trailerSize);
+            const qint64 toRead = remaining < 0 ? bufferSize : qMin(qint64(bufferSize), remaining);
+            const qint64 haveRead = source->read(buffer.data() + headerSize, toRead);
+            if (haveRead < 0) {
+                // The response cannot be completed, the client has to notice
+                qCWarning(rspLc, "Error reading chunk: %ls",
+                          qUtf16Printable(source->errorString()));
+                done = true;
+                sink->close();
+                source->deleteLater();
+                return;
+            }
+            if (haveRead == 0) {
+                // A sequential source that has no data now may have more
+                // later, and readyRead() resumes the transfer then
+                if (source->isSequential() ? sourceFinished : source->atEnd())
+                    finish();
+                return;
+            }
+
+            if (remaining > 0)
+                remaining -= haveRead;
+            if (haveRead == bufferSize)
+                bufferSize = qMin(2 * bufferSize, maxBufferSize);
+            else if (haveRead < bufferSize / 4)
+                bufferSize = qMax(bufferSize / 2, qMin(MinBufferSize, maxBufferSize));
+
+            buffer.truncate(headerSize + haveRead + trailerSize);
+            if (chunked) {
+                // One chunk for each read, sized to what the source produced
+                char *data = buffer.data();
+                qint64 size = haveRead;
+                for (qsizetype i = ChunkSizeDigits - 1; i >= 0; --i, size >>= 4)
+                    data[i] = QtMiscUtils::toHexLower(char32_t(size & 0xf));
+                memcpy(data + ChunkSizeDigits, "\r\n", 2);
+                memcpy(data + headerSize + haveRead, "\r\n", 2);
+            }
+
+            if (sink->write(buffer) < 0) {
+                qCWarning(rspLc, "Error writing chunk: %ls", qUtf16Printable(sink->errorString()));
+                return;
+            }
+            nextBuffer ^= 1;
+        }
     }
 
-    void readFromInput()
+    void finish()
     {
-        if (!isBufferEmpty()) // We haven't consumed all the data yet.
+        if (std::exchange(done, true))
             return;
-        beginIndex = 0;
-        endIndex = source->read(buffer, bufferSize);
-        if (endIndex < 0) {
-            endIndex = beginIndex; // Mark the buffer as empty
-            qCWarning(rspLc, "Error reading chunk: %ls", qUtf16Printable(source->errorString()));
-        } else if (endIndex) {
-            memset(buffer + endIndex, 0, sizeof(buffer) - std::size_t(endIndex));
-            writeToOutput();
-        }
+        if (chunked)
+            sink->write("0\r\n\r\n");
+        source->deleteLater();
     }
+};
+
+/*!
+    \internal
+
+    Streams \a input to \a output, and calls \a finished once \a input is
+    consumed and deleted. If \a chunked is \c true, the data is framed in
+    chunked transfer coding. If \a length is not negative, only that many
+    bytes are sent. \a inputFinished tells that a sequential \a input
+    already emitted readChannelFinished(). \a maxBufferSize limits the size
+    of a read from \a input. Takes ownership of \a input.
+*/
+void QHttpServerResponderPrivate::transfer(QIODevice *input, QIODevice *output, bool chunked,
+                                           qint64 length, bool inputFinished,
+                                           qsizetype maxBufferSize,
+                                           std::function<void()> finished)
+{
+    // input takes ownership of the IOChunkedTransfer pointer inside his constructor
+    new IOChunkedTransfer(input, output, chunked, length, inputFinished, maxBufferSize,
+                          std::move(finished));
+}
 
-    void writeToOutput()
+#if defined(Q_OS_LINUX)
+/*!
+    \internal
+
+    Sends the rest of a file to a plain socket with sendfile(), which moves
+    the data from the page cache to the socket without copying it through
+    user space.
+
+    The data the socket still has queued, such as the head of the response,
+    is written first. Whenever the send buffer of the socket is full, the
+    transfer waits for the socket descriptor to become writable again. The
+    transfer ends when the socket is closed.
+*/
+struct FileTransfer
+{
+    // Large enough to fill any send buffer, well below the limit of sendfile()
+    static constexpr qint64 MaxSendSize = qint64(1) << 30;
+
+    QPointer<QFile> source;
+    const QPointer<QIODevice> sink;
+    const int fileDescriptor;
+    const int socketDescriptor;
+    qint64 offset;
+    qint64 remaining;
+    QSocketNotifier *notifier = nullptr;
+    QMetaObject::Connection bytesWrittenConnection;
+    // Set once the transfer waited for the socket
+    bool waited = false;
+    // Called when data was sent, and when the transfer starts waiting for
+    // the socket. The sink does not see the data sendfile() writes.
+    const std::function<void()> progressed;
+    // Called once the file is sent, or the sink is gone
+    const std::function<void()> finished;
+
+    FileTransfer(QFile *input, QIODevice *output, qintptr outputDescriptor, qint64 length,
+                 std::function<void()> progressed, std::function<void()> finished) :
+        source(input),
+        sink(output),
+        fileDescriptor(input->handle()),
+        socketDescriptor(int(outputDescriptor)),
+        offset(input->pos()),
+        remaining(length < 0 ? qMax(qint64(0), input->size() - input->pos()) : length),
+        progressed(std::move(progressed)),
+        finished(std::move(finished))
     {
-        if (isBufferEmpty())
-            return;
+        QObject::connect(sink.data(), &QObject::destroyed, source.data(), &QObject::deleteLater);
+        QObject::connect(source.data(), &QObject::destroyed, source.data(), [this]() {
+            delete this;
+        });
+        // The descriptor is closed, or about to be
+        QObject::connect(sink.data(), &QIODevice::aboutToClose, source.data(), [this]() {
+            stop();
+        });
 
-        const auto writtenBytes = sink->write(buffer + beginIndex, endIndex);
-        if (writtenBytes < 0) {
-            qCWarning(rspLc, "Error writing chunk: %ls", qUtf16Printable(sink->errorString()));
+        if (sink->bytesToWrite() == 0) {
+            send();
             return;
         }
-        beginIndex += writtenBytes;
-        if (isBufferEmpty()) {
-            if (source->bytesAvailable())
-                QTimer::singleShot(0, source.data(), [this]() { readFromInput(); });
-            else if (source->atEnd()) // Finishing
-                source->deleteLater();
+        bytesWrittenConnection = QObject::connect(sink.data(), &QIODevice::bytesWritten,
+                                                  source.data(), [this]() {
+            if (sink->bytesToWrite() > 0)
+                return;
+            QObject::disconnect(bytesWrittenConnection);
+            send();
+        });
+    }
+
+    ~FileTransfer()
+    {
+        QObject::disconnect(bytesWrittenConnection);
+        if (finished)
+            finished();
+    }
+
+    void stop()
+    {
+        QObject::disconnect(bytesWrittenConnection);
+        if (notifier)
+            notifier->setEnabled(false);
+        remaining = 0;
+        source->deleteLater();
+    }
+
+    void send()
+    {
+        bool sentAny = false;
+        while (sink && sink->isOpen() && remaining > 0) {
+            off_t position = off_t(offset);
+            const ssize_t sent = ::sendfile(socketDescriptor, fileDescriptor, &position,
+                                            size_t(qMin(remaining, MaxSendSize)));
+            if (sent > 0) {
+                offset += sent;
+                remaining -= sent;
+                sentAny = true;
+                if (progressed)
+                    progressed();
+                continue;
+            }
+            if (sent < 0 && errno == EINTR)
+                continue;
+            if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                // A wait after progress is covered by the call above
+                if (!waited && !sentAny && progressed)
+                    progressed();
+                waited = true;
+                if (!notifier) {
+                    notifier = new QSocketNotifier(socketDescriptor, QSocketNotifier::Write,
+                                                   source.data());
+                    QObject::connect(notifier, &QSocketNotifier::activated, notifier, [this]() {
+                        notifier->setEnabled(false);
+                        send();
+                    });
+                }
+                notifier->setEnabled(true);
+                return;
+            }
+
+            // The file got shorter than its announced length, or the
+            // connection broke. The client has to notice the response is
+            // incomplete.
+            if (sent < 0)
+                qCWarning(rspLc, "Error sending file: %ls", qUtf16Printable(qt_error_string(errno)));
+            else
+                qCWarning(rspLc, "Error sending file: unexpected end of file");
+            sink->close();
+            break;
         }
+        source->deleteLater();
     }
 };
 
 /*!
     \internal
+
+    Sends \a input to \a output, writing directly to \a outputDescriptor,
+    the descriptor of \a output. \a output must not encrypt or otherwise
+    transform the data it writes. If \a length is not negative, only that
+    many bytes are sent. Calls \a progressed whenever data was sent and
+    when the transfer starts waiting for \a output, so that the caller can
+    time out a client that stops reading. Calls \a finished once \a input
+    is sent and deleted, or \a output is closed. Takes ownership of
+    \a input.
+*/
+void QHttpServerResponderPrivate::sendFile(QFile *input, QIODevice *output,
+                                           qintptr outputDescriptor, qint64 length,
+                                           std::function<void()> progressed,
+                                           std::function<void()> finished)
+{
+    // input takes ownership of the FileTransfer pointer inside its constructor
+    new FileTransfer(input, output, outputDescriptor, length, std::move(progressed),
+                     std::move(finished));
+}
+#endif // Q_OS_LINUX
+
+/*!
+    \internal
+
+    Creates the responder for the last request of the pipeline of \a stream.
 */
 QHttpServerResponder::QHttpServerResponder(QHttpServerStream *stream)
     : d_ptr(new QHttpServerResponderPrivate(stream))
 {
     Q_ASSERT(stream);
-    Q_ASSERT(!stream->handlingRequest);
-    stream->handlingRequest = true;
+    Q_ASSERT(!stream->pipeline.empty());
+    d_ptr->exchange = &stream->pipeline.back();
 }
 
 /*!
@@ -297,7 +755,13 @@ QHttpServerResponder::~QHttpServerResponder()
     Q_D(QHttpServerResponder);
     if (d) {
         Q_ASSERT(d->stream);
-        d->stream->responderDestroyed();
+        // The handler wrote the status line and headers but no body
+        if (!d->head.isEmpty()) {
+            d->writeDefaultHeaders();
+            d->head += "\r\n";
+            d->stream->write(d->exchange, std::exchange(d->head, {}), nullptr, 0);
+        }
+        d->stream->responderDestroyed(d->exchange);
     }
 }
 
@@ -305,9 +769,19 @@ QHttpServerResponder::~QHttpServerResponder()
     Answers a request with an HTTP status code \a status and
     HTTP headers \a headers. The I/O device \a data provides the body
     of the response. If \a data is sequential, the body of the
-    message is sent in chunks: otherwise, the function assumes all
-    the content is available and sends it all at once but the read
-    is done in chunks.
+    message is sent as it is read, with chunked transfer coding, unless
+    \a headers contain a \c Content-Length or \c Transfer-Encoding.
+    HTTP/1.0 clients do not support chunked transfer coding, so their
+    connection is closed after the body instead. The body of a sequential
+    device ends once it emits QIODevice::readChannelFinished() or is
+    closed. Otherwise, the function assumes all the content is available
+    and sends it all at once but the read is done in chunks.
+
+    If \a data is not sequential and \a status is \c{200 OK}, GET
+    requests with a \c Range header are answered with the requested byte
+    ranges, and only those are read from \a data. An \c If-Range header
+    is compared with the \c ETag or \c Last-Modified header in
+    \a headers.
 
     \note This function takes the ownership of \a data.
 */
@@ -334,34 +808,79 @@ void QHttpServerResponder::write(QIODevice *data,
         return;
     }
 
+    // Clients can ask for parts of bodies of a known size
+    const bool seekable = !input->isSequential();
+    if (seekable && status == StatusCode::Ok && d->requestsRanges()) {
+        std::vector<std::pair<QByteArray, QByteArray>> rangeHeaders(headers.begin(),
+                                                                     headers.end());
+        rangeHeaders.emplace_back(QHttpServerLiterals::acceptRangesHeader(),
+                                  QHttpServerLiterals::acceptRangesBytes());
+        if (d->writeRanges(this, input, rangeHeaders))
+            return;
+    }
+
     writeStatusLine(status);
 
-    if (!input->isSequential()) { // Non-sequential QIODevice should know its data size
+    // The end of the body is known from its length, or from the framing
+    // the handler chose
+    bool delimited = seekable;
+    if (seekable) { // Non-sequential QIODevice should know its data size
         writeHeader(QHttpServerLiterals::contentLengthHeader(),
                     QByteArray::number(input->size()));
+        if (status == StatusCode::Ok) {
+            writeHeader(QHttpServerLiterals::acceptRangesHeader(),
+                        QHttpServerLiterals::acceptRangesBytes());
+        }
     }
 
-    for (auto &&header : headers)
+    for (auto &&header : headers) {
         writeHeader(header.first, header.second);
+        if (header.first.compare(QHttpServerLiterals::contentLengthHeader(),
+                                 Qt::CaseInsensitive) == 0
+            || header.first.compare(QHttpServerLiterals::transferEncodingHeader(),
+                                    Qt::CaseInsensitive) == 0) {
+            delimited = true;
+        }
+    }
+
+    // Otherwise, HTTP/1.1 clients find the end from the chunked framing, and
+    // HTTP/1.0 ones from the end of the connection
+    const QHttpServerRequestPrivate *request = d->exchange->request->d.get();
+    d->exchange->chunkedBody = false;
+    if (!delimited) {
+        if (request->parser.getMajorVersion() == 1 && request->parser.getMinorVersion() == 0) {
+            d->stream->closeAfterResponse = true;
+            if (d->defaultHeaders & QHttpServerResponderPrivate::ConnectionHeader)
+                d->exchange->connectionHeader = "close";
+        } else {
+            writeHeader(QHttpServerLiterals::transferEncodingHeader(),
+                        QHttpServerLiterals::transferEncodingChunked());
+            d->exchange->chunkedBody = true;
+        }
+    }
 
-    d->stream->write("\r\n");
+    writeBody(nullptr, 0);
 
-    if (input->atEnd()) {
+    // A sequential device that has no data yet may still produce some
+    if (seekable && input->atEnd()) {
         qCDebug(rspLc, "No more data available.");
+        if (d->exchange->chunkedBody)
+            writeBody("0\r\n\r\n");
         return;
     }
 
-    // input takes ownership of the IOChunkedTransfer pointer inside his constructor
-    new IOChunkedTransfer<>(input.release(), d->stream->socket);
+    d->stream->write(d->exchange, input.release());
 }
 
 /*!
     Answers a request with an HTTP status code \a status and a
     MIME type \a mimeType. The I/O device \a data provides the body
     of the response. If \a data is sequential, the body of the
-    message is sent in chunks: otherwise, the function assumes all
-    the content is available and sends it all at once but the read
-    is done in chunks.
+    message is sent as it is read, with chunked transfer coding, or
+    until the connection is closed for HTTP/1.0 clients. The body of a
+    sequential device ends once it emits QIODevice::readChannelFinished()
+    or is closed. Otherwise, the function assumes all the content is
+    available and sends it all at once but the read is done in chunks.
 
     \note This function takes the ownership of \a data.
 */
@@ -417,6 +936,14 @@ void QHttpServerResponder::write(const QByteArray &data,
                                  HeaderList headers,
                                  StatusCode status)
 {
+    Q_D(QHttpServerResponder);
+
+    // The status line, Content-Length and the empty line
+    qsizetype headSize = 64;
+    for (auto &&header : headers)
+        headSize += header.first.size() + header.second.size() + 4;
+    d->head.reserve(d->head.size() + headSize);
+
     writeStatusLine(status);
 
     for (auto &&header : headers)
@@ -467,14 +994,25 @@ void QHttpServerResponder::writeStatusLine(StatusCode status)
     Q_D(QHttpServerResponder);
     Q_ASSERT(d->stream);
     d->bodyStarted = false;
-    d->stream->write("HTTP/1.1 ");
-    d->stream->write(QByteArray::number(quint32(status)));
-    const auto it = statusString.find(status);
-    if (it != statusString.end()) {
-        d->stream->write(" ");
-        d->stream->write(statusString.at(status));
-    }
-    d->stream->write("\r\n");
+
+    const QHttpServerConfiguration &configuration = d->stream->configuration;
+    d->defaultHeaders = 0;
+    if (configuration.isDateHeaderEnabled())
+        d->defaultHeaders |= QHttpServerResponderPrivate::DateHeader;
+    if (!configuration.serverHeader().isEmpty())
+        d->defaultHeaders |= QHttpServerResponderPrivate::ServerHeader;
+    if (!d->exchange->connectionHeader.isEmpty())
+        d->defaultHeaders |= QHttpServerResponderPrivate::ConnectionHeader;
+
+    const qsizetype code = qsizetype(status);
+    if (code >= FirstStatusCode && code <= LastStatusCode
+        && !statusLines[code - FirstStatusCode].isEmpty()) {
+        d->head += statusLines[code - FirstStatusCode];
+    } else {
+        d->head += "HTTP/1.1 ";
+        d->head += QByteArray::number(quint32(status));
+        d->head += "\r\n";
+    }
 }
 
 /*!
@@ -484,12 +1022,24 @@ void QHttpServerResponder::writeStatusLine(StatusCode status)
 void QHttpServerResponder::writeHeader(const QByteArray &header,
                                        const QByteArray &value)
 {
-    Q_D(const QHttpServerResponder);
+    Q_D(QHttpServerResponder);
     Q_ASSERT(d->stream);
-    d->stream->write(header);
-    d->stream->write(": ");
-    d->stream->write(value);
-    d->stream->write("\r\n");
+    if (d->defaultHeaders) {
+        if (header.compare("Date", Qt::CaseInsensitive) == 0)
+            d->defaultHeaders &= ~QHttpServerResponderPrivate::DateHeader;
+        else if (header.compare("Server", Qt::CaseInsensitive) == 0)
+            d->defaultHeaders &= ~QHttpServerResponderPrivate::ServerHeader;
+    }
+    if (header.compare("Connection", Qt::CaseInsensitive) == 0) {
+        d->defaultHeaders &= ~QHttpServerResponderPrivate::ConnectionHeader;
+        // The handler asks to close the connection after this response
+        if (value.toLower().contains("close"))
+            d->stream->closeAfterResponse = true;
+    }
+    d->head += header;
+    d->head += ": ";
+    d->head += value;
+    d->head += "\r\n";
 }
 
 /*!
@@ -511,11 +1061,14 @@ void QHttpServerResponder::writeBody(const char *body, qint64 size)
     Q_ASSERT(d->stream);
 
     if (!d->bodyStarted) {
-        d->stream->write("\r\n");
+        d->writeDefaultHeaders();
+        d->head += "\r\n";
         d->bodyStarted = true;
+        d->stream->write(d->exchange, std::exchange(d->head, {}), body, size);
+        return;
     }
 
-    d->stream->write(body, size);
+    d->stream->write(d->exchange, body, size);
 }
 
 /*!
@@ -537,21 +1090,93 @@ void QHttpServerResponder::writeBody(const QByteArray &body)
 /*!
     Sends a HTTP \a response to the client.
 
+    If the status of \a response is \c{200 OK}, GET requests with a
+    \c Range header are answered with the requested byte ranges of its
+    body.
+
     \since 6.5
 */
 void QHttpServerResponder::sendResponse(const QHttpServerResponse &response)
 {
     const auto &d = response.d_ptr;
 
+    // Large files from QHttpServerResponse::fromFile() are streamed
+    std::unique_ptr<QFile> file;
+    if (!d->fileName.isEmpty()) {
+        file = std::make_unique<QFile>(d->fileName);
+        if (!file->open(QIODevice::ReadOnly)) {
+            qCDebug(rspLc, "404: Could not open file %ls", qUtf16Printable(file->errorString()));
+            write(StatusCode::NotFound);
+            return;
+        }
+    }
+
+    const auto contentType = [&]() -> QByteArray {
+        const QByteArray &defaultContentType = d_func()->defaultContentType;
+        return d->detectedContentType.isNull() && !defaultContentType.isEmpty()
+                ? defaultContentType
+                : d->pendingContentType();
+    };
+
+    if (d->statusCode == StatusCode::Ok && d_func()->requestsRanges()) {
+        std::vector<std::pair<QByteArray, QByteArray>> headers(d->headers.cbegin(),
+                                                                d->headers.cend());
+        if (d->contentTypePending)
+            headers.emplace_back(QHttpServerLiterals::contentTypeHeader(), contentType());
+        if (file) {
+            headers.emplace_back(QHttpServerLiterals::acceptRangesHeader(),
+                                 QHttpServerLiterals::acceptRangesBytes());
+        }
+
+        std::unique_ptr<QIODevice, QScopedPointerDeleteLater> body;
+        if (file) {
+            body.reset(file.release());
+        } else {
+            auto buffer = new QBuffer;
+            buffer->setData(d->data);
+            buffer->open(QIODevice::ReadOnly);
+            body.reset(buffer);
+        }
+        if (d_func()->writeRanges(this, body, headers))
+            return;
+        if (!d->fileName.isEmpty())
+            file.reset(static_cast<QFile *>(body.release()));
+    }
+
+    // The status line, Content-Type, Content-Length and the empty line
+    qsizetype headSize = 128;
+    for (auto &&header : d->headers)
+        headSize += header.first.size() + header.second.size() + 4;
+    d_func()->head.reserve(d_func()->head.size() + headSize);
+
     writeStatusLine(d->statusCode);
 
     for (auto &&header : d->headers)
         writeHeader(header.first, header.second);
 
-    writeHeader(QHttpServerLiterals::contentLengthHeader(),
-                QByteArray::number(d->data.size()));
+    if (d->contentTypePending)
+        writeHeader(QHttpServerLiterals::contentTypeHeader(), contentType());
+
+    // A 304 has no body, and its Content-Length would be the one of the
+    // representation
+    if (d->statusCode != StatusCode::NotModified) {
+        writeHeader(QHttpServerLiterals::contentLengthHeader(),
+                    QByteArray::number(file ? file->size() : d->data.size()));
+    }
+    if (file && d->statusCode == StatusCode::Ok) {
+        writeHeader(QHttpServerLiterals::acceptRangesHeader(),
+                    QHttpServerLiterals::acceptRangesBytes());
+    }
+
+    if (!file) {
+        writeBody(d->data);
+        return;
+    }
 
-    writeBody(d->data);
+    writeBody(nullptr, 0);
+    d_func()->exchange->chunkedBody = false;
+    if (!file->atEnd())
+        d_func()->stream->write(d_func()->exchange, file.release());
 }
 
 QT_END_NAMESPACE
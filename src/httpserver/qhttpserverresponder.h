@@ -26,6 +26,8 @@ class Q_HTTPSERVER_EXPORT QHttpServerResponder final
     Q_DECLARE_PRIVATE(QHttpServerResponder)
 
     friend class QHttpServerStream;
+    friend class QHttpServer;
+    friend class QHttpServerRouterRule;
 
 public:
     enum class StatusCode {
@@ -15,7 +15,10 @@
 #include <QtCore/qpointer.h>
 #include <QtCore/qsysinfo.h>
 
+#include <functional>
+#include <memory>
 #include <type_traits>
+#include <vector>
 
 //
 //  W A R N I N G
@@ -29,6 +32,9 @@
 
 QT_BEGIN_NAMESPACE
 
+class QFile;
+class QHttpServerResponsePrivate;
+
 class QHttpServerResponderPrivate
 {
 public:
@@ -39,7 +45,39 @@ public:
 #else
     QHttpServerStream *const stream;
 #endif
+    // The request of the stream this responder answers
+    QHttpServerStream::Exchange *exchange = nullptr;
     bool bodyStarted{false};
+    // The status line and the headers, sent together with the start of
+    // the body
+    QByteArray head;
+
+    // The headers of the configuration and of the connection that the
+    // handler has not written itself, added at the end of the head
+    enum DefaultHeader {
+        DateHeader = 0x1,
+        ServerHeader = 0x2,
+        ConnectionHeader = 0x4,
+    };
+    int defaultHeaders = 0;
+
+    void writeDefaultHeaders();
+    static void transfer(QIODevice *input, QIODevice *output, bool chunked, qint64 length,
+                         bool inputFinished, qsizetype maxBufferSize,
+                         std::function<void()> finished);
+#if defined(Q_OS_LINUX)
+    static void sendFile(QFile *input, QIODevice *output, qintptr outputDescriptor,
+                         qint64 length, std::function<void()> progressed,
+                         std::function<void()> finished);
+#endif
+    void evaluateConditions(QHttpServerResponsePrivate *response) const;
+    bool requestsRanges() const;
+    bool writeRanges(QHttpServerResponder *q,
+                     std::unique_ptr<QIODevice, QScopedPointerDeleteLater> &device,
+                     const std::vector<std::pair<QByteArray, QByteArray>> &headers);
+    // The MIME type declared by the rule that handles the request, used
+    // for responses created without one.
+    QByteArray defaultContentType;
 };
 
 QT_END_NAMESPACE
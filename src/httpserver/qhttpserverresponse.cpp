@@ -4,13 +4,13 @@
 #include <QtHttpServer/qhttpserverresponse.h>
 
 #include <private/qhttpserverliterals_p.h>
+#include <private/qhttpservermimetypes_p.h>
 #include <private/qhttpserverresponse_p.h>
 #include <private/qhttpserverresponder_p.h>
 
 #include <QtCore/qfile.h>
 #include <QtCore/qjsondocument.h>
 #include <QtCore/qjsonobject.h>
-#include <QtCore/qmimedatabase.h>
 #include <QtNetwork/qtcpsocket.h>
 
 QT_BEGIN_NAMESPACE
@@ -45,6 +45,54 @@ QHttpServerResponsePrivate::QHttpServerResponsePrivate(const QHttpServerResponse
     : statusCode(sc)
 { }
 
+/*!
+    \internal
+*/
+bool QHttpServerResponsePrivate::isContentTypeHeader(const QByteArray &name)
+{
+    return name.compare(QHttpServerLiterals::contentTypeHeader(), Qt::CaseInsensitive) == 0;
+}
+
+/*!
+    \internal
+
+    Returns the MIME type the response will be sent with if no Content-Type
+    header is set, or a null QByteArray if the response has no such type.
+*/
+QByteArray QHttpServerResponsePrivate::pendingContentType() const
+{
+    if (!contentTypePending)
+        return {};
+    if (detectedContentType.isNull())
+        detectedContentType = QHttpServerMimeTypes::forData(data);
+    return detectedContentType;
+}
+
+/*!
+    \internal
+
+    Uses \a mimeType instead of detecting the MIME type from the data, if
+    the response was created without one.
+*/
+void QHttpServerResponsePrivate::setDefaultContentType(const QByteArray &mimeType)
+{
+    if (contentTypePending && !mimeType.isEmpty())
+        detectedContentType = mimeType;
+}
+
+/*!
+    \internal
+
+    Turns the pending MIME type into a Content-Type header.
+*/
+void QHttpServerResponsePrivate::resolveContentType()
+{
+    if (!contentTypePending)
+        return;
+    headers.emplace(QHttpServerLiterals::contentTypeHeader(), pendingContentType());
+    contentTypePending = false;
+}
+
 /*!
     \typealias QHttpServerResponse::StatusCode
 
@@ -100,20 +148,33 @@ QHttpServerResponse::QHttpServerResponse(const QString &data, const StatusCode s
 
 /*!
     Creates a QHttpServerResponse object from \a data with the status code \a status.
+
+    The MIME type of the response is detected from \a data when it is first
+    needed, unless the route that handles the request declares one.
+
+    \sa QHttpServerRouterRule::setContentType()
 */
 QHttpServerResponse::QHttpServerResponse(const QByteArray &data, const StatusCode status)
-    : QHttpServerResponse(QMimeDatabase().mimeTypeForData(data).name().toLocal8Bit(), data, status)
+    : QHttpServerResponse(QByteArray(), data, status)
 {
+    Q_D(QHttpServerResponse);
+    d->contentTypePending = true;
 }
 
 /*!
     Move-constructs a QHttpServerResponse whose body will contain the given
     \a data with the status code \a status.
+
+    The MIME type of the response is detected from \a data when it is first
+    needed, unless the route that handles the request declares one.
+
+    \sa QHttpServerRouterRule::setContentType()
 */
 QHttpServerResponse::QHttpServerResponse(QByteArray &&data, const StatusCode status)
-    : QHttpServerResponse(QMimeDatabase().mimeTypeForData(data).name().toLocal8Bit(),
-                          std::move(data), status)
+    : QHttpServerResponse(QByteArray(), std::move(data), status)
 {
+    Q_D(QHttpServerResponse);
+    d->contentTypePending = true;
 }
 
 /*!
@@ -201,9 +262,20 @@ QHttpServerResponse::~QHttpServerResponse()
 {
 }
 
+// Files up to this size are read into the response, larger ones are sent
+// from the file system when the response is written.
+static constexpr qint64 InlineFileSize = 64 * 1024;
+// What QMimeDatabase reads of a file to detect its type from the content
+static constexpr qint64 MimeSniffSize = 16 * 1024;
+
 /*!
     Returns a QHttpServerResponse from the content of the file \a fileName.
 
+    Files larger than 64 KiB are not read into memory. Their content is
+    read when the response is sent, or when data() is called. Where the
+    platform supports it, the kernel then copies the file to the socket
+    directly, unless the connection is encrypted.
+
     It is the caller's responsibility to sanity-check the filename, and to have
     a well-defined policy for which files the server will request.
 */
@@ -212,18 +284,36 @@ QHttpServerResponse QHttpServerResponse::fromFile(const QString &fileName)
     QFile file(fileName);
     if (!file.open(QFile::ReadOnly))
         return QHttpServerResponse(StatusCode::NotFound);
+
+    // Resources and other files without a descriptor are not worth the
+    // second open
+    if (file.size() > InlineFileSize && file.handle() != -1) {
+        const QByteArray mimeType =
+                QHttpServerMimeTypes::forFileNameAndData(fileName, file.peek(MimeSniffSize));
+        QHttpServerResponse response(mimeType, QByteArray());
+        response.d_func()->fileName = fileName;
+        return response;
+    }
+
     const QByteArray data = file.readAll();
     file.close();
-    const QByteArray mimeType = QMimeDatabase().mimeTypeForFileNameAndData(fileName, data).name().toLocal8Bit();
+    const QByteArray mimeType = QHttpServerMimeTypes::forFileNameAndData(fileName, data);
     return QHttpServerResponse(mimeType, data);
 }
 
 /*!
     Returns the response body.
+
+    For a response that fromFile() created from a large file, the file is
+    read on each call.
 */
 QByteArray QHttpServerResponse::data() const
 {
     Q_D(const QHttpServerResponse);
+    if (!d->fileName.isEmpty()) {
+        QFile file(d->fileName);
+        return file.open(QFile::ReadOnly) ? file.readAll() : QByteArray();
+    }
     return d->data;
 }
 
@@ -246,8 +336,11 @@ QByteArray QHttpServerResponse::mimeType() const
     Q_D(const QHttpServerResponse);
     const auto res = d->headers.find(
             QHttpServerLiterals::contentTypeHeader());
-    if (res == d->headers.end())
+    if (res == d->headers.end()) {
+        if (d->contentTypePending)
+            return d->pendingContentType();
         return QHttpServerLiterals::contentTypeTextHtml();
+    }
 
     return res->second;
 }
@@ -259,6 +352,8 @@ QByteArray QHttpServerResponse::mimeType() const
 void QHttpServerResponse::addHeader(QByteArray &&name, QByteArray &&value)
 {
     Q_D(QHttpServerResponse);
+    if (QHttpServerResponsePrivate::isContentTypeHeader(name))
+        d->resolveContentType();
     d->headers.emplace(std::move(name), std::move(value));
 }
 
@@ -269,6 +364,8 @@ void QHttpServerResponse::addHeader(QByteArray &&name, QByteArray &&value)
 void QHttpServerResponse::addHeader(QByteArray &&name, const QByteArray &value)
 {
     Q_D(QHttpServerResponse);
+    if (QHttpServerResponsePrivate::isContentTypeHeader(name))
+        d->resolveContentType();
     d->headers.emplace(std::move(name), value);
 }
 
@@ -279,6 +376,8 @@ void QHttpServerResponse::addHeader(QByteArray &&name, const QByteArray &value)
 void QHttpServerResponse::addHeader(const QByteArray &name, QByteArray &&value)
 {
     Q_D(QHttpServerResponse);
+    if (QHttpServerResponsePrivate::isContentTypeHeader(name))
+        d->resolveContentType();
     d->headers.emplace(name, std::move(value));
 }
 
@@ -289,6 +388,8 @@ void QHttpServerResponse::addHeader(const QByteArray &name, QByteArray &&value)
 void QHttpServerResponse::addHeader(const QByteArray &name, const QByteArray &value)
 {
     Q_D(QHttpServerResponse);
+    if (QHttpServerResponsePrivate::isContentTypeHeader(name))
+        d->resolveContentType();
     d->headers.emplace(name, value);
 }
 
@@ -318,6 +419,8 @@ void QHttpServerResponse::addHeaders(QHttpServerResponder::HeaderList headers)
 void QHttpServerResponse::clearHeader(const QByteArray &name)
 {
     Q_D(QHttpServerResponse);
+    if (QHttpServerResponsePrivate::isContentTypeHeader(name))
+        d->contentTypePending = false;
     d->headers.erase(name);
 }
 
@@ -327,6 +430,7 @@ void QHttpServerResponse::clearHeader(const QByteArray &name)
 void QHttpServerResponse::clearHeaders()
 {
     Q_D(QHttpServerResponse);
+    d->contentTypePending = false;
     d->headers.clear();
 }
 
@@ -386,6 +490,8 @@ void QHttpServerResponse::setHeaders(QHttpServerResponder::HeaderList headers)
 bool QHttpServerResponse::hasHeader(const QByteArray &header) const
 {
     Q_D(const QHttpServerResponse);
+    if (d->contentTypePending && QHttpServerResponsePrivate::isContentTypeHeader(header))
+        return true;
     return d->headers.find(header) != d->headers.end();
 }
 
@@ -397,6 +503,11 @@ bool QHttpServerResponse::hasHeader(const QByteArray &name,
                                     const QByteArray &value) const
 {
     Q_D(const QHttpServerResponse);
+    if (d->contentTypePending && QHttpServerResponsePrivate::isContentTypeHeader(name)
+            && d->pendingContentType() == value) {
+        return true;
+    }
+
     auto range = d->headers.equal_range(name);
 
     auto condition = [&value] (const std::pair<QByteArray, QByteArray> &pair) {
@@ -414,6 +525,9 @@ QList<QByteArray> QHttpServerResponse::headers(const QByteArray &name) const
     Q_D(const QHttpServerResponse);
 
     QList<QByteArray> results;
+    if (d->contentTypePending && QHttpServerResponsePrivate::isContentTypeHeader(name))
+        results.append(d->pendingContentType());
+
     auto range = d->headers.equal_range(name);
 
     for (auto it = range.first; it != range.second; ++it)
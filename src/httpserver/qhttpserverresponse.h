@@ -19,6 +19,8 @@ class Q_HTTPSERVER_EXPORT QHttpServerResponse final
     Q_DISABLE_COPY(QHttpServerResponse)
 
     friend class QHttpServerResponder;
+    friend class QHttpServer;
+    friend class QHttpServerFileCache;
 public:
     using StatusCode = QHttpServerResponder::StatusCode;
 
@@ -36,9 +36,24 @@ public:
     QHttpServerResponsePrivate(QByteArray &&d, const QHttpServerResponse::StatusCode sc);
     QHttpServerResponsePrivate(const QHttpServerResponse::StatusCode sc);
 
+    static bool isContentTypeHeader(const QByteArray &name);
+
+    QByteArray pendingContentType() const;
+    void setDefaultContentType(const QByteArray &mimeType);
+    void resolveContentType();
+
     QByteArray data;
+    // Set by fromFile() for large files, which are sent from the file when
+    // the response is written instead of being held in data
+    QString fileName;
     QHttpServerResponse::StatusCode statusCode;
     std::unordered_multimap<QByteArray, QByteArray, HashHelper> headers;
+
+    // Set when the response was created without a MIME type. The
+    // Content-Type header is then derived from the data only once it is
+    // asked for or the response is sent.
+    bool contentTypePending = false;
+    mutable QByteArray detectedContentType;
 };
 
 QT_END_NAMESPACE
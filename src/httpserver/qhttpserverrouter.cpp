@@ -6,12 +6,17 @@
 #include <QtHttpServer/qhttpserverrouter.h>
 #include <QtHttpServer/qhttpserverrouterrule.h>
 #include <QtHttpServer/qhttpserverrequest.h>
+#include <QtHttpServer/qhttpserverresponder.h>
 
+#include <private/qhttpserverliterals_p.h>
 #include <private/qhttpserverrouterrule_p.h>
 
 #include <QtCore/qloggingcategory.h>
 #include <QtCore/qmetatype.h>
 
+#include <algorithm>
+#include <typeinfo>
+
 QT_BEGIN_NAMESPACE
 
 Q_LOGGING_CATEGORY(lcRouter, "qt.httpserver.router")
@@ -171,10 +176,92 @@ static const QHash<QMetaType, QString> defaultConverters = {
     \endcode
 */
 
+/*! \fn template<typename ViewHandler, typename ViewTraits = QHttpServerRouterViewTraits<ViewHandler>> typename ViewTraits::BindableType QHttpServerRouter::bindCaptured(ViewHandler &&handler, const QRegularExpressionMatch &match, bool *ok) const
+
+    \since 6.7
+    \overload
+
+    Supplies the \a handler with arguments derived from a URL, and sets
+    \a ok to \c false if any of them could not be converted to the type of
+    the handler's parameter, for example because a number is out of range.
+    Otherwise, \a ok is set to \c true.
+
+    Integers, floating point numbers, QString, QByteArray and QUrl are
+    converted directly from \a match. Other types are converted via
+    QVariant, and never cause \a ok to be \c false.
+*/
+
 QHttpServerRouterPrivate::QHttpServerRouterPrivate()
     : converters(defaultConverters)
 {}
 
+/*!
+    \internal
+
+    Returns the position of the index for \a method in indexes.
+*/
+std::size_t QHttpServerRouterPrivate::methodIndex(QHttpServerRequest::Method method)
+{
+    if (method == QHttpServerRequest::Method::Unknown)
+        return 0;
+    return qCountTrailingZeroBits(uint(method)) + 1;
+}
+
+/*!
+    \internal
+
+    Returns the kinds of the converters for \a metaTypes, as used by the
+    router index. Converters differing from the default ones are of unknown
+    kind, as it is unknown which paths they match.
+*/
+QList<QHttpServerRouterIndex::ParamKind>
+QHttpServerRouterPrivate::paramKinds(std::initializer_list<QMetaType> metaTypes) const
+{
+    using ParamKind = QHttpServerRouterIndex::ParamKind;
+
+    QList<ParamKind> kinds;
+    for (auto metaType : metaTypes) {
+        const QString converter = converters.value(metaType);
+        if (converter.isEmpty())
+            continue; // Skipped by QHttpServerRouterRule::createPathRegexp()
+
+        if (converter != defaultConverters.value(metaType)) {
+            kinds.append(ParamKind::Unknown);
+            continue;
+        }
+
+        switch (metaType.id()) {
+        case QMetaType::Int:
+        case QMetaType::Long:
+        case QMetaType::LongLong:
+        case QMetaType::Short:
+            kinds.append(ParamKind::Integer);
+            break;
+        case QMetaType::UInt:
+        case QMetaType::ULong:
+        case QMetaType::ULongLong:
+        case QMetaType::UShort:
+            kinds.append(ParamKind::Unsigned);
+            break;
+        case QMetaType::Double:
+        case QMetaType::Float:
+            kinds.append(ParamKind::Float);
+            break;
+        case QMetaType::QString:
+        case QMetaType::QByteArray:
+            kinds.append(ParamKind::Segment);
+            break;
+        case QMetaType::QUrl:
+            kinds.append(ParamKind::Tail);
+            break;
+        default:
+            kinds.append(ParamKind::Unknown);
+            break;
+        }
+    }
+    return kinds;
+}
+
 /*!
     Creates a QHttpServerRouter object with default converters.
 
@@ -259,6 +346,22 @@ bool QHttpServerRouter::addRuleImpl(std::unique_ptr<QHttpServerRouterRule> rule,
         return false;
     }
 
+    // Subclasses may reimplement matches(), so only plain rules are indexed,
+    // in the index of each of their methods
+    const qsizetype index = qsizetype(d->rules.size());
+    const QHttpServerRouterRule &plainRule = *rule;
+    if (typeid(plainRule) == typeid(QHttpServerRouterRule)) {
+        const auto paramKinds = d->paramKinds(metaTypes);
+        const auto methods = rule->d_func()->methods;
+        for (std::size_t i = 1; i < d->indexes.size(); ++i) {
+            if (methods.testAnyFlags(QHttpServerRequest::Method(1 << (i - 1))))
+                d->indexes[i].addRule(index, rule->d_func()->pathPattern, paramKinds);
+        }
+    } else {
+        for (auto &methodIndex : d->indexes)
+            methodIndex.addUnindexedRule(index);
+    }
+
     d->rules.push_back(std::move(rule));
     return true;
 }
@@ -269,17 +372,131 @@ bool QHttpServerRouter::addRuleImpl(std::unique_ptr<QHttpServerRouterRule> rule,
     Iterates through the list of rules to find the first that matches,
     then executes this rule, returning \c true. Returns \c false if no rule
     matches the request.
+
+    Only the rules for the method of \a request whose path pattern may match
+    its path are tried. They are looked up in an index built when the rules
+    are added.
+
+    If no rule matches, but the path of \a request matches rules for other
+    methods, the request is answered with status 405 Method Not Allowed and
+    an \c Allow header listing these methods, and \c true is returned. Only
+    rules of the QHttpServerRouterRule class itself are taken into account
+    for this, as subclasses may match requests differently.
+
+    \sa QHttpServerResponder::StatusCode
 */
 bool QHttpServerRouter::handleRequest(const QHttpServerRequest &request,
                                       QHttpServerResponder &responder) const
+{
+    if (handleMatchingRule(request, responder))
+        return true;
+
+    const QByteArray allow = allowedMethods(request);
+    if (allow.isEmpty())
+        return false;
+
+    responder.write(QByteArray(),
+                    { { QHttpServerLiterals::contentTypeHeader(),
+                        QHttpServerLiterals::contentTypeXEmpty() },
+                      { QByteArrayLiteral("Allow"), allow } },
+                    QHttpServerResponder::StatusCode::MethodNotAllowed);
+    return true;
+}
+
+/*!
+    \internal
+
+    Executes the first rule for the method of \a request that matches it,
+    returning \c true, or returns \c false if there is none.
+*/
+bool QHttpServerRouter::handleMatchingRule(const QHttpServerRequest &request,
+                                           QHttpServerResponder &responder) const
 {
     Q_D(const QHttpServerRouter);
-    for (const auto &rule : d->rules) {
-        if (rule->exec(request, responder))
+    QHttpServerRouterIndex::Candidates candidates;
+    d->indexes[d->methodIndex(request.method())].findCandidates(request.url().path(),
+                                                                &candidates);
+    for (qsizetype candidate : std::as_const(candidates)) {
+        if (d->rules[candidate]->exec(request, responder))
             return true;
     }
-
     return false;
 }
 
+/*!
+    \internal
+
+    Returns the value of an \c Allow header listing the other methods
+    that have rules matching the path of \a request, or an empty byte
+    array if there are none. Only rules of the QHttpServerRouterRule class
+    itself are taken into account, as subclasses may match requests
+    differently.
+*/
+QByteArray QHttpServerRouter::allowedMethods(const QHttpServerRequest &request) const
+{
+    Q_D(const QHttpServerRouter);
+    const QString path = request.url().path();
+    QHttpServerRouterIndex::Candidates candidates;
+
+    const auto matchesPath = [&path](const QHttpServerRouterRule &rule) {
+        if (typeid(rule) != typeid(QHttpServerRouterRule))
+            return false;
+        const QRegularExpression &pathRegexp = rule.d_func()->pathRegexp;
+        const QRegularExpressionMatch match = pathRegexp.match(path);
+        return match.hasMatch() && pathRegexp.captureCount() == match.lastCapturedIndex();
+    };
+
+    static constexpr std::pair<QHttpServerRequest::Method, QLatin1StringView> methodNames[] = {
+        { QHttpServerRequest::Method::Get, "GET"_L1 },
+        { QHttpServerRequest::Method::Put, "PUT"_L1 },
+        { QHttpServerRequest::Method::Delete, "DELETE"_L1 },
+        { QHttpServerRequest::Method::Post, "POST"_L1 },
+        { QHttpServerRequest::Method::Head, "HEAD"_L1 },
+        { QHttpServerRequest::Method::Options, "OPTIONS"_L1 },
+        { QHttpServerRequest::Method::Patch, "PATCH"_L1 },
+        { QHttpServerRequest::Method::Connect, "CONNECT"_L1 },
+        { QHttpServerRequest::Method::Trace, "TRACE"_L1 },
+    };
+
+    QByteArray allow;
+    for (const auto &[method, name] : methodNames) {
+        if (method == request.method())
+            continue;
+        candidates.clear();
+        d->indexes[d->methodIndex(method)].findCandidates(path, &candidates);
+        const bool allowed = std::any_of(candidates.cbegin(), candidates.cend(),
+                                         [&](qsizetype candidate) {
+                                             return matchesPath(*d->rules[candidate]);
+                                         });
+        if (allowed) {
+            if (!allow.isEmpty())
+                allow.append(", ");
+            allow.append(name);
+        }
+    }
+    return allow;
+}
+
+/*!
+    \internal
+
+    Returns the first rule that matches \a request, or \nullptr if there is
+    none. This is asked once the headers of a request with a body are read.
+*/
+const QHttpServerRouterRule *QHttpServerRouter::matchingRule(
+        const QHttpServerRequest &request) const
+{
+    Q_D(const QHttpServerRouter);
+    QHttpServerRouterIndex::Candidates candidates;
+    d->indexes[d->methodIndex(request.method())].findCandidates(request.url().path(),
+                                                                &candidates);
+    QRegularExpressionMatch match;
+    for (qsizetype candidate : std::as_const(candidates)) {
+        const QHttpServerRouterRule &rule = *d->rules[candidate];
+        if (rule.matches(request, &match))
+            return &rule;
+    }
+    return nullptr;
+}
+
 QT_END_NAMESPACE
@@ -57,8 +57,19 @@ public:
     typename ViewTraits::BindableType bindCaptured(ViewHandler &&handler,
                       const QRegularExpressionMatch &match) const
     {
+        bool ok = true;
         return bindCapturedImpl<ViewHandler, ViewTraits>(
-                std::forward<ViewHandler>(handler), match,
+                std::forward<ViewHandler>(handler), match, &ok,
+                typename ViewTraits::Arguments::CapturableIndexes{});
+    }
+
+    template<typename ViewHandler, typename ViewTraits = QHttpServerRouterViewTraits<ViewHandler>>
+    typename ViewTraits::BindableType bindCaptured(ViewHandler &&handler,
+                      const QRegularExpressionMatch &match, bool *ok) const
+    {
+        *ok = true;
+        return bindCapturedImpl<ViewHandler, ViewTraits>(
+                std::forward<ViewHandler>(handler), match, ok,
                 typename ViewTraits::Arguments::CapturableIndexes{});
     }
 
@@ -91,15 +102,24 @@ private:
     template<typename ViewHandler, typename ViewTraits, int... Cx>
     typename ViewTraits::BindableType bindCapturedImpl(ViewHandler &&handler,
                                                        const QRegularExpressionMatch &match,
+                                                       bool *ok,
                                                        QtPrivate::IndexesList<Cx...>) const
     {
         return bind_front(
                 std::forward<ViewHandler>(handler),
-                QVariant(match.captured(Cx + 1))
-                        .value<typename ViewTraits::Arguments::template Arg<Cx>::CleanType>()...);
+                QtPrivate::convertCaptured<
+                        typename ViewTraits::Arguments::template Arg<Cx>::CleanType>(
+                        match.capturedView(Cx + 1), ok)...);
     }
 
+    bool handleMatchingRule(const QHttpServerRequest &request,
+                            QHttpServerResponder &responder) const;
+    QByteArray allowedMethods(const QHttpServerRequest &request) const;
+    const QHttpServerRouterRule *matchingRule(const QHttpServerRequest &request) const;
+
     std::unique_ptr<QHttpServerRouterPrivate> d_ptr;
+
+    friend class QHttpServerPrivate;
 };
 
 QT_END_NAMESPACE
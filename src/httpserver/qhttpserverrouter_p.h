@@ -6,10 +6,14 @@
 
 #include <QtHttpServer/qhttpserverrouter.h>
 #include <QtHttpServer/qhttpserverrouterrule.h>
+#include <QtHttpServer/qhttpserverrequest.h>
+
+#include <private/qhttpserverrouterindex_p.h>
 
 #include <QtCore/qhash.h>
 #include <QtCore/qstring.h>
 
+#include <array>
 #include <memory>
 #include <vector>
 
@@ -32,6 +36,13 @@ public:
 
     QHash<QMetaType, QString> converters;
     std::vector<std::unique_ptr<QHttpServerRouterRule>> rules;
+    // One index per method, the first one is used for unknown methods
+    std::array<QHttpServerRouterIndex, 10> indexes;
+
+    static std::size_t methodIndex(QHttpServerRequest::Method method);
+
+    QList<QHttpServerRouterIndex::ParamKind>
+    paramKinds(std::initializer_list<QMetaType> metaTypes) const;
 };
 
 QT_END_NAMESPACE
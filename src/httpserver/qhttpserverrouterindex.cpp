@@ -0,0 +1,229 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "qhttpserverrouterindex_p.h"
+
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE
+
+using namespace Qt::StringLiterals;
+
+/*!
+    \internal
+*/
+QHttpServerRouterIndex::QHttpServerRouterIndex() = default;
+
+/*!
+    \internal
+*/
+QHttpServerRouterIndex::~QHttpServerRouterIndex() = default;
+
+static bool isMetaCharacter(QChar c)
+{
+    switch (c.unicode()) {
+    case u'.': case u'^': case u'$': case u'|': case u'?': case u'*': case u'+':
+    case u'(': case u')': case u'[': case u']': case u'{': case u'}':
+        return true;
+    default:
+        return false;
+    }
+}
+
+static void splitPath(QStringView path, QVarLengthArray<QStringView, 16> *segments)
+{
+    qsizetype begin = 0;
+    for (qsizetype end; (end = path.indexOf(u'/', begin)) != -1; begin = end + 1)
+        segments->append(path.sliced(begin, end - begin));
+    segments->append(path.sliced(begin));
+}
+
+/*!
+    \internal
+
+    Adds the \a rule with the given \a pathPattern to the index. The \a params
+    are the kinds of the converters used for the arguments of the rule, in
+    the order their regular expressions replace the \c <arg> placeholders or
+    are appended to the pattern, as in
+    QHttpServerRouterRule::createPathRegexp().
+
+    If the pattern contains regular expression syntax other than escaped
+    characters, or a parameter that cannot be indexed, the rule is added as
+    an unindexed rule.
+*/
+void QHttpServerRouterIndex::addRule(qsizetype rule, QStringView pathPattern,
+                                     const QList<ParamKind> &params)
+{
+    struct Segment
+    {
+        QString text;
+        QList<ParamKind> params;
+    };
+    std::vector<Segment> segments(1);
+
+    QStringView pattern = pathPattern;
+    if (pattern.startsWith(u'^'))
+        pattern = pattern.sliced(1);
+    if (pattern.endsWith(u'$') && !pattern.endsWith(u"\\$"))
+        pattern.chop(1);
+
+    const auto arg = "<arg>"_L1;
+    qsizetype nextParam = 0;
+    for (qsizetype i = 0; i < pattern.size();) {
+        if (pattern.sliced(i).startsWith(arg) && nextParam < params.size()) {
+            segments.back().params.append(params.at(nextParam++));
+            i += arg.size();
+            continue;
+        }
+
+        QChar c = pattern.at(i);
+        if (c == u'\\') {
+            if (i + 1 == pattern.size() || pattern.at(i + 1).isLetterOrNumber()) {
+                addUnindexedRule(rule); // A character class like \d
+                return;
+            }
+            c = pattern.at(i + 1);
+            i += 2;
+        } else if (isMetaCharacter(c)) {
+            addUnindexedRule(rule);
+            return;
+        } else {
+            ++i;
+        }
+
+        if (c == u'/')
+            segments.emplace_back();
+        else
+            segments.back().text.append(c);
+    }
+    while (nextParam < params.size())
+        segments.back().params.append(params.at(nextParam++));
+
+    Node *node = &root;
+    for (std::size_t i = 0; i < segments.size(); ++i) {
+        const Segment &segment = segments[i];
+        if (segment.params.isEmpty()) {
+            auto &child = node->literals[segment.text];
+            if (!child)
+                child = std::make_unique<Node>();
+            node = child.get();
+            continue;
+        }
+
+        if (segment.params.contains(ParamKind::Unknown)) {
+            addUnindexedRule(rule);
+            return;
+        }
+
+        if (segment.params.contains(ParamKind::Tail)) {
+            if (i + 1 != segments.size() || segment.params.size() != 1
+                || !segment.text.isEmpty()) {
+                addUnindexedRule(rule);
+                return;
+            }
+            node->tailRules.push_back(rule);
+            return;
+        }
+
+        const ParamKind kind = segment.params.size() == 1 && segment.text.isEmpty()
+                ? segment.params.first()
+                : ParamKind::Any;
+        auto it = std::find_if(node->params.begin(), node->params.end(),
+                               [kind](const auto &param) { return param.first == kind; });
+        if (it == node->params.end()) {
+            node->params.emplace_back(kind, std::make_unique<Node>());
+            it = std::prev(node->params.end());
+        }
+        node = it->second.get();
+    }
+    node->rules.push_back(rule);
+}
+
+/*!
+    \internal
+
+    Adds the \a rule as a candidate for every path.
+*/
+void QHttpServerRouterIndex::addUnindexedRule(qsizetype rule)
+{
+    unindexedRules.push_back(rule);
+}
+
+/*!
+    \internal
+
+    Returns \c true if a parameter of the given \a kind may match
+    \a segment. Only ASCII characters are checked, as the regular
+    expressions of the converters also match other Unicode digits.
+*/
+bool QHttpServerRouterIndex::accepts(ParamKind kind, QStringView segment)
+{
+    const auto acceptsChars = [segment](QLatin1StringView allowed) {
+        if (segment.isEmpty())
+            return false;
+        for (QChar c : segment) {
+            if (c.unicode() < 0x80 && !c.isDigit() && !allowed.contains(c))
+                return false;
+        }
+        return true;
+    };
+
+    switch (kind) {
+    case ParamKind::Integer:
+        return acceptsChars("+-"_L1);
+    case ParamKind::Unsigned:
+        return acceptsChars("+"_L1);
+    case ParamKind::Float:
+        return acceptsChars("+-."_L1);
+    case ParamKind::Segment:
+        return !segment.isEmpty();
+    case ParamKind::Any:
+        return true;
+    case ParamKind::Unknown:
+    case ParamKind::Tail:
+        break;
+    }
+    Q_UNREACHABLE_RETURN(false);
+}
+
+/*!
+    \internal
+*/
+void QHttpServerRouterIndex::collect(const Node *node, const Segments &segments,
+                                     qsizetype depth, Candidates *candidates)
+{
+    if (depth == segments.size()) {
+        candidates->append(node->rules.data(), qsizetype(node->rules.size()));
+        return;
+    }
+
+    candidates->append(node->tailRules.data(), qsizetype(node->tailRules.size()));
+
+    const QStringView segment = segments.at(depth);
+    const auto literal = node->literals.find(segment);
+    if (literal != node->literals.end())
+        collect(literal->second.get(), segments, depth + 1, candidates);
+
+    for (const auto &[kind, child] : node->params) {
+        if (accepts(kind, segment))
+            collect(child.get(), segments, depth + 1, candidates);
+    }
+}
+
+/*!
+    \internal
+
+    Stores the rules which may match \a path into \a candidates, in the
+    order the rules were added.
+*/
+void QHttpServerRouterIndex::findCandidates(QStringView path, Candidates *candidates) const
+{
+    Segments segments;
+    splitPath(path, &segments);
+
+    collect(&root, segments, 0, candidates);
+    candidates->append(unindexedRules.data(), qsizetype(unindexedRules.size()));
+    std::sort(candidates->begin(), candidates->end());
+}
+
+QT_END_NAMESPACE
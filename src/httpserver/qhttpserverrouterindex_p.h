@@ -0,0 +1,83 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef QHTTPSERVERROUTERINDEX_P_H
+#define QHTTPSERVERROUTERINDEX_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists for the convenience
+// of QHttpServer. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+
+#include <QtHttpServer/qthttpserverglobal.h>
+
+#include <QtCore/qlist.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qvarlengtharray.h>
+
+#include <map>
+#include <memory>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+
+// Maps request paths to the rules that may match them.
+//
+// Path patterns are split into segments at '/' and stored in a trie, so
+// that finding the candidate rules depends on the depth of the path and not
+// on the number of rules. Segments are either literal text, or parameters
+// using one of the default converters, which never match a '/'. Rules whose
+// pattern cannot be represented this way are candidates for every path.
+//
+// The index only narrows down the rules, the candidates still need to be
+// matched against their regular expression, in the order they were added.
+class QHttpServerRouterIndex
+{
+public:
+    enum class ParamKind {
+        Unknown,    // A custom converter, the rule is not indexed
+        Integer,
+        Unsigned,
+        Float,
+        Segment,    // Any non-empty segment
+        Tail,       // The rest of the path, possibly spanning several segments
+        Any,        // A segment mixing text and parameters
+    };
+
+    using Candidates = QVarLengthArray<qsizetype, 16>;
+
+    QHttpServerRouterIndex();
+    ~QHttpServerRouterIndex();
+
+    void addRule(qsizetype rule, QStringView pathPattern, const QList<ParamKind> &params);
+    void addUnindexedRule(qsizetype rule);
+
+    void findCandidates(QStringView path, Candidates *candidates) const;
+
+private:
+    struct Node
+    {
+        std::map<QString, std::unique_ptr<Node>, std::less<>> literals;
+        std::vector<std::pair<ParamKind, std::unique_ptr<Node>>> params;
+        std::vector<qsizetype> rules;
+        std::vector<qsizetype> tailRules;
+    };
+
+    using Segments = QVarLengthArray<QStringView, 16>;
+
+    static bool accepts(ParamKind kind, QStringView segment);
+    static void collect(const Node *node, const Segments &segments, qsizetype depth,
+                        Candidates *candidates);
+
+    Node root;
+    std::vector<qsizetype> unindexedRules;
+};
+
+QT_END_NAMESPACE
+
+#endif // QHTTPSERVERROUTERINDEX_P_H
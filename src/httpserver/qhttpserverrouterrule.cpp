@@ -5,6 +5,7 @@
 
 #include <private/qhttpserverrouterrule_p.h>
 #include <private/qhttpserverrequest_p.h>
+#include <private/qhttpserverresponder_p.h>
 
 #include <QtCore/qmetaobject.h>
 #include <QtCore/qloggingcategory.h>
@@ -111,6 +112,32 @@ QHttpServerRouterRule::QHttpServerRouterRule(const QString &pathPattern,
 {
 }
 
+/*!
+    \since 6.7
+
+    Constructs a rule with pathPattern \a pathPattern, methods \a methods,
+    contentType \a contentType and routerHandler \a routerHandler.
+
+    This constructor is also used by QHttpServer::route() when it is given
+    a MIME type between the methods and the view handler:
+
+    \code
+    server.route("/hello", QHttpServerRequest::Method::Get, "text/plain"_ba, [] () {
+        return "Hello world";
+    });
+    \endcode
+
+    \sa setContentType()
+*/
+QHttpServerRouterRule::QHttpServerRouterRule(const QString &pathPattern,
+                                             const QHttpServerRequest::Methods methods,
+                                             const QByteArray &contentType,
+                                             RouterHandler routerHandler)
+    : QHttpServerRouterRule(pathPattern, methods, std::move(routerHandler))
+{
+    setContentType(contentType);
+}
+
 /*!
     \internal
  */
@@ -126,6 +153,129 @@ QHttpServerRouterRule::~QHttpServerRouterRule()
 {
 }
 
+/*!
+    \since 6.7
+
+    Returns the MIME type of the responses of this rule.
+
+    \sa setContentType()
+*/
+QByteArray QHttpServerRouterRule::contentType() const
+{
+    Q_D(const QHttpServerRouterRule);
+    return d->contentType;
+}
+
+/*!
+    \since 6.7
+
+    Sets the MIME type of the responses of this rule to \a contentType.
+
+    Responses that are created without a MIME type, for example from a
+    QByteArray or a QString, are sent with \a contentType instead of a type
+    detected from their data. Responses with an explicit MIME type are not
+    affected.
+
+    \sa contentType()
+*/
+void QHttpServerRouterRule::setContentType(const QByteArray &contentType)
+{
+    Q_D(QHttpServerRouterRule);
+    d->contentType = contentType;
+}
+
+/*!
+    \since 6.7
+
+    Returns \c true if the handler of this rule reads the request body as
+    it arrives.
+
+    \sa setStreamingBody()
+*/
+bool QHttpServerRouterRule::isStreamingBody() const
+{
+    Q_D(const QHttpServerRouterRule);
+    return d->streamingBody;
+}
+
+/*!
+    \since 6.7
+
+    Enables streaming of request bodies to the handler of this rule if
+    \a enable is \c true.
+
+    By default, the whole body of a request is read into memory before the
+    handler is called, and QHttpServerRequest::body() returns it. With
+    streaming enabled, the handler is called as soon as the request headers
+    are read, and reads the body from QHttpServerRequest::bodyDevice() as it
+    arrives. This keeps the memory used by large uploads bounded.
+
+    \code
+    auto viewHandler = [] () { };
+    using ViewHandler = decltype(viewHandler);
+
+    auto rule = std::make_unique<QHttpServerRouterRule>(
+            "/upload", QHttpServerRequest::Method::Post,
+            [](const QRegularExpressionMatch &, const QHttpServerRequest &request,
+               QHttpServerResponder &&responder) {
+                auto file = new QTemporaryFile;
+                file->open();
+                QIODevice *body = request.bodyDevice();
+                QObject::connect(body, &QIODevice::readyRead, file, [body, file]() {
+                    file->write(body->readAll());
+                });
+                QObject::connect(body, &QIODevice::readChannelFinished, file,
+                                 [body, file, responder = std::move(responder)]() mutable {
+                    file->write(body->readAll());
+                    responder.write(QHttpServerResponder::StatusCode::Ok);
+                    file->deleteLater();
+                });
+            });
+    rule->setStreamingBody(true);
+    server.router()->addRule<ViewHandler>(std::move(rule));
+    \endcode
+
+    \sa isStreamingBody(), QHttpServerRequest::bodyDevice()
+*/
+void QHttpServerRouterRule::setStreamingBody(bool enable)
+{
+    Q_D(QHttpServerRouterRule);
+    d->streamingBody = enable;
+}
+
+/*!
+    \since 6.7
+
+    Returns the largest request body this rule accepts, in bytes, or a
+    negative value if the limit of the server configuration applies.
+
+    \sa setMaxBodySize()
+*/
+qint64 QHttpServerRouterRule::maxBodySize() const
+{
+    Q_D(const QHttpServerRouterRule);
+    return d->maxBodySize;
+}
+
+/*!
+    \since 6.7
+
+    Sets the largest request body this rule accepts to \a size bytes,
+    replacing QHttpServerConfiguration::maxBodySize() for the requests it
+    matches. This lets an upload route accept large bodies while the rest
+    of the server keeps a small limit.
+
+    A \a size of zero means no limit. A negative \a size, the default, uses
+    the limit of the server configuration.
+
+    \sa maxBodySize(), QHttpServerConfiguration::setMaxBodySize()
+*/
+void QHttpServerRouterRule::setMaxBodySize(qint64 size)
+{
+    Q_D(QHttpServerRouterRule);
+    d->maxBodySize = size;
+}
+
 /*!
     Returns \c true if the methods is valid
 */
@@ -152,6 +302,7 @@ bool QHttpServerRouterRule::exec(const QHttpServerRequest &request,
     if (!matches(request, &match))
         return false;
 
+    responder.d_func()->defaultContentType = d->contentType;
     d->routerHandler(match, request, std::move(responder));
     return true;
 }
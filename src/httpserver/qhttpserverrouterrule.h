@@ -34,8 +34,21 @@ public:
     explicit QHttpServerRouterRule(const QString &pathPattern,
                                    const QHttpServerRequest::Methods methods,
                                    RouterHandler routerHandler);
+    explicit QHttpServerRouterRule(const QString &pathPattern,
+                                   const QHttpServerRequest::Methods methods,
+                                   const QByteArray &contentType,
+                                   RouterHandler routerHandler);
     virtual ~QHttpServerRouterRule();
 
+    QByteArray contentType() const;
+    void setContentType(const QByteArray &contentType);
+
+    bool isStreamingBody() const;
+    void setStreamingBody(bool enable);
+
+    qint64 maxBodySize() const;
+    void setMaxBodySize(qint64 size);
+
 protected:
     bool exec(const QHttpServerRequest &request, QHttpServerResponder &responder) const;
 
@@ -29,6 +29,9 @@ public:
     QHttpServerRouterRule::RouterHandler routerHandler;
 
     QRegularExpression pathRegexp;
+    QByteArray contentType;
+    bool streamingBody = false;
+    qint64 maxBodySize = -1;
 };
 
 QT_END_NAMESPACE
@@ -7,6 +7,14 @@
 
 #include <QtHttpServer/qhttpserverviewtraits_impl.h>
 
+#include <QtCore/qbytearray.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qurl.h>
+#include <QtCore/qvariant.h>
+
+#include <limits>
+#include <type_traits>
+
 QT_BEGIN_NAMESPACE
 
 class QHttpServerRequest;
@@ -14,6 +22,75 @@ class QHttpServerResponder;
 
 namespace QtPrivate {
 
+template<typename T>
+using IsCapturedInteger = std::disjunction<
+        std::is_same<T, short>, std::is_same<T, int>, std::is_same<T, long>,
+        std::is_same<T, long long>, std::is_same<T, unsigned short>,
+        std::is_same<T, unsigned int>, std::is_same<T, unsigned long>,
+        std::is_same<T, unsigned long long>>;
+
+template<typename T>
+T parseCapturedInteger(QStringView captured, bool *ok)
+{
+    using Unsigned = std::make_unsigned_t<T>;
+
+    qsizetype i = 0;
+    bool negative = false;
+    if (!captured.isEmpty() && (captured[0] == u'+' || captured[0] == u'-')) {
+        negative = captured[0] == u'-';
+        ++i;
+    }
+    if (i == captured.size() || (negative && std::is_unsigned_v<T>)) {
+        *ok = false;
+        return T{};
+    }
+
+    const Unsigned limit = negative ? Unsigned(Unsigned(std::numeric_limits<T>::max()) + 1u)
+                                    : Unsigned(std::numeric_limits<T>::max());
+    Unsigned value = 0;
+    for (; i < captured.size(); ++i) {
+        const char16_t c = captured[i].unicode();
+        if (c < u'0' || c > u'9' || value > Unsigned(limit - (c - u'0')) / 10u) {
+            *ok = false;
+            return T{};
+        }
+        value = Unsigned(value * 10u + Unsigned(c - u'0'));
+    }
+    return negative ? T(Unsigned(0u - value)) : T(value);
+}
+
+// Converts a string captured from the URL to the type of a view handler
+// argument. Built-in types are parsed directly, other types go through
+// the QVariant conversion registered for them. Sets *ok to false if the
+// string is out of the range of the type, and leaves it untouched otherwise.
+template<typename T>
+T convertCaptured(QStringView captured, bool *ok)
+{
+    if constexpr (IsCapturedInteger<T>::value) {
+        return parseCapturedInteger<T>(captured, ok);
+    } else if constexpr (std::is_same_v<T, double>) {
+        bool converted = false;
+        const double value = captured.toDouble(&converted);
+        if (!converted)
+            *ok = false;
+        return value;
+    } else if constexpr (std::is_same_v<T, float>) {
+        bool converted = false;
+        const float value = captured.toFloat(&converted);
+        if (!converted)
+            *ok = false;
+        return value;
+    } else if constexpr (std::is_same_v<T, QString>) {
+        return captured.toString();
+    } else if constexpr (std::is_same_v<T, QByteArray>) {
+        return captured.toUtf8();
+    } else if constexpr (std::is_same_v<T, QUrl>) {
+        return QUrl(captured.toString());
+    } else {
+        return QVariant(captured.toString()).value<T>();
+    }
+}
+
 template<typename ViewHandler, bool DisableStaticAssert>
 struct RouterViewTraitsHelper : ViewTraits<ViewHandler, DisableStaticAssert> {
     using VTraits = ViewTraits<ViewHandler, DisableStaticAssert>;
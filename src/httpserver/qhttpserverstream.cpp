@@ -6,40 +6,249 @@
 #include <QtHttpServer/qhttpserverrequest.h>
 #include <QtHttpServer/qabstracthttpserver.h>
 #include <QtHttpServer/qhttpserverresponder.h>
+#include <QtCore/qfile.h>
 #include <QtCore/qmetaobject.h>
+#include <QtCore/qpointer.h>
 #include <QtCore/qthread.h>
 #include <QtCore/qloggingcategory.h>
 #include <QtNetwork/qlocalsocket.h>
 #include <QtNetwork/qtcpsocket.h>
 
 #include <private/qhttpserverrequest_p.h>
+#include <private/qhttpserverresponder_p.h>
 #include <private/qabstracthttpserver_p.h>
 
+#if defined(Q_OS_UNIX)
+#include <private/qnet_unix_p.h>
+#include <sys/uio.h>
+#endif
+
 QT_BEGIN_NAMESPACE
 
 Q_LOGGING_CATEGORY(lcHttpServerStream, "qt.httpserver.stream")
 
 void QHttpServerStream::handleReadyRead()
 {
-    if (handlingRequest)
+    using State = QHttpServerRequestPrivate::State;
+
+    // Read ahead as many requests as the pipeline depth allows
+    const qsizetype depth = configuration.pipelineDepth();
+    while (socket && (bodyExchange || !closeAfterResponse)) {
+        if (bodyExchange) {
+            if (!readStreamedBody())
+                return;
+            continue;
+        }
+
+        if (qsizetype(pipeline.size()) >= depth)
+            return;
+
+        if (!socket->isTransactionStarted())
+            socket->startTransaction();
+
+        if (!request.d->parse(socket)) {
+            rejectRequest();
+            return;
+        }
+
+        if (!request.d->bodyModeChosen
+            && (request.d->state == State::ExpectContinue
+                || request.d->state == State::ReadingData)) {
+            // The headers are complete. Either the handler gets the request
+            // now and reads the body as it arrives, or the body is read
+            // into the request first.
+            request.d->bodyModeChosen = true;
+            const auto policy = server->d_func()->requestBodyPolicy(request);
+            request.d->maxBodySize =
+                    policy.maxSize < 0 ? configuration.maxBodySize() : policy.maxSize;
+            if (request.d->maxBodySize > 0 && request.d->bodyLength > request.d->maxBodySize) {
+                // Before 100 Continue, so a well-behaved client does not
+                // even send the body
+                request.d->error = QHttpServerRequestPrivate::Error::BodyTooLarge;
+                rejectRequest();
+                return;
+            }
+            if (policy.stream) {
+                armDeadline(Deadline::None);
+                if (!handleRequest(true))
+                    return;
+            }
+            continue;
+        }
+
+        if (request.d->state != State::AllDone) {
+            updateReadDeadline();
+            return; // Partial read
+        }
+
+#if defined(QT_WEBSOCKETS_LIB)
+        if (request.d->upgrade && !pipeline.empty()) {
+            // Read again once the earlier responses are sent
+            socket->rollbackTransaction();
+            return;
+        }
+#endif // QT_WEBSOCKETS_LIB
+
+        armDeadline(Deadline::None);
+
+        if (!handleRequest(false))
+            return;
+    }
+}
+
+/*!
+    \internal
+
+    Answers the request that could not be read with the status code for
+    its parse error, and closes the connection after the response. The
+    connection is closed right away if the request is malformed.
+*/
+void QHttpServerStream::rejectRequest()
+{
+    using Error = QHttpServerRequestPrivate::Error;
+    using StatusCode = QHttpServerResponder::StatusCode;
+
+    StatusCode status;
+    switch (request.d->error) {
+    case Error::RequestLineTooLong:
+        status = StatusCode::UriTooLong;
+        break;
+    case Error::HeaderTooLarge:
+        status = StatusCode::RequestHeaderFieldsTooLarge;
+        break;
+    case Error::BodyTooLarge:
+        status = StatusCode::PayloadTooLarge;
+        break;
+    case Error::None:
+    case Error::Malformed:
+        closeConnection();
         return;
+    }
+
+    qCDebug(lcHttpServerStream) << "Rejecting request with status" << int(status);
+
+    armDeadline(Deadline::None);
+    socket->commitTransaction();
+    closeAfterResponse = true;
+
+    // The response is ordered after the ones to earlier requests
+    Exchange &exchange = pipeline.emplace_back();
+    exchange.sequence = nextSequence++;
+    exchange.connectionHeader = "close";
+    exchange.request = takeRequest();
+    QHttpServerResponder responder(this);
+    responder.write(status);
+}
+
+/*!
+    \internal
+
+    Reads more of the body that is streamed to the handler. Returns \c true
+    once the body is complete.
+*/
+bool QHttpServerStream::readStreamedBody()
+{
+    using State = QHttpServerRequestPrivate::State;
+
+    QHttpServerRequestPrivate *d = bodyExchange->request->d.get();
+    QHttpServerRequestBody *device = d->bodyDevice.get();
+
+    // Nobody reads the rest of the body once the response is sent
+    if (bodyExchange->responderDone)
+        device->skip(device->bytesAvailable());
+
+    if (device->isFull()) {
+        // Waiting for the handler, not for the client
+        armDeadline(Deadline::None);
+        return false;
+    }
+
+    if (!d->parse(socket)) {
+        if (d->error != QHttpServerRequestPrivate::Error::BodyTooLarge) {
+            closeConnection();
+            return false;
+        }
+        // The handler already has the request, it learns from the body
+        // device. The rest of the body is not read.
+        device->reject();
+        bodyExchange->connectionHeader = "close";
+        closeAfterResponse = true;
+        finishStreamedBody();
+        return false;
+    }
+
+    if (d->state != State::AllDone) {
+        armDeadline(Deadline::Body);
+        return false;
+    }
+
+    finishStreamedBody();
+    return true;
+}
 
-    if (!socket->isTransactionStarted())
-        socket->startTransaction();
+/*!
+    \internal
+*/
+void QHttpServerStream::finishStreamedBody()
+{
+    Exchange *exchange = std::exchange(bodyExchange, nullptr);
+    exchange->readingBody = false;
+    armDeadline(Deadline::None);
+
+    if (tcpSocket)
+        tcpSocket->setReadBufferSize(0);
+#if QT_CONFIG(localserver)
+    else if (localSocket)
+        localSocket->setReadBufferSize(0);
+#endif
+
+    advancePipeline();
+}
+
+/*!
+    \internal
 
-    if (!request.d->parse(socket)) {
+    Hands the request that was just read to the server. If \a streamBody is
+    \c true, only its headers are read, and the body is passed to the
+    handler as it arrives. Returns \c false if the stream stops reading
+    from the socket.
+*/
+bool QHttpServerStream::handleRequest(bool streamBody)
+{
+    ++requestCount;
+    const int maxRequests = configuration.maxRequestsPerConnection();
+    closeAfterResponse = !request.d->keepAlive
+            || (maxRequests > 0 && requestCount >= maxRequests);
+
+    Exchange &exchange = pipeline.emplace_back();
+    exchange.sequence = nextSequence++;
+    if (closeAfterResponse)
+        exchange.connectionHeader = "close";
+    else if (request.d->parser.getMajorVersion() == 1 && request.d->parser.getMinorVersion() == 0)
+        exchange.connectionHeader = "keep-alive";
+    exchange.request = takeRequest();
+    const QHttpServerRequest &request = *exchange.request;
+
+    if (streamBody) {
+        request.d->bodyDevice = std::make_unique<QHttpServerRequestBody>(
+                [stream = QPointer(this)]() {
+                    if (stream) {
+                        QMetaObject::invokeMethod(stream, &QHttpServerStream::handleReadyRead,
+                                                  Qt::QueuedConnection);
+                    }
+                });
+        exchange.readingBody = true;
+        bodyExchange = &exchange;
+
+        // Let the socket stop reading while the handler catches up
         if (tcpSocket)
-            tcpSocket->disconnectFromHost();
+            tcpSocket->setReadBufferSize(QHttpServerRequestBody::BufferLimit);
 #if QT_CONFIG(localserver)
         else if (localSocket)
-            localSocket->disconnectFromServer();
+            localSocket->setReadBufferSize(QHttpServerRequestBody::BufferLimit);
 #endif
-        return;
     }
 
-    if (request.d->state != QHttpServerRequestPrivate::State::AllDone)
-        return; // Partial read
-
     qCDebug(lcHttpServerStream) << "Request:" << request;
 
     QHttpServerResponder responder(this);
@@ -56,8 +265,25 @@ void QHttpServerStream::handleReadyRead()
                     // Socket will now be managed by websocketServer
                     socket->disconnect();
                     socket->rollbackTransaction();
+                    socket = nullptr;
+                    this->tcpSocket = nullptr;
+                    if (thread() != server->thread()) {
+                        // The WebSocket server lives in the thread of the
+                        // HTTP server, hand the socket over to it.
+                        tcpSocket->setParent(nullptr);
+                        tcpSocket->moveToThread(server->thread());
+                        QMetaObject::invokeMethod(
+                                server,
+                                [server = server, tcpSocket]() {
+                                    server->d_func()->websocketServer.handleConnection(tcpSocket);
+                                    Q_EMIT tcpSocket->readyRead();
+                                },
+                                Qt::QueuedConnection);
+                        deleteLater();
+                        return false;
+                    }
                     server->d_func()->websocketServer.handleConnection(tcpSocket);
-                    Q_EMIT socket->readyRead();
+                    Q_EMIT tcpSocket->readyRead();
                 } else {
                     qWarning(lcHttpServerStream,
                             "WebSocket received but no slots connected to "
@@ -65,7 +291,7 @@ void QHttpServerStream::handleReadyRead()
                     server->missingHandler(request, std::move(responder));
                     tcpSocket->disconnectFromHost();
                 }
-                return;
+                return false;
             }
         }
     }
@@ -75,19 +301,219 @@ void QHttpServerStream::handleReadyRead()
 
     if (!server->handleRequest(request, responder))
         server->missingHandler(request, std::move(responder));
+    return true;
+}
+
+/*!
+    \internal
+
+    Copies the limits of the configuration that apply while the request
+    line and the headers are read to \a d.
+*/
+void QHttpServerStream::applyLimits(QHttpServerRequestPrivate *d) const
+{
+    d->maxRequestLineSize = configuration.maxRequestLineSize();
+    d->maxHeaderSize = configuration.maxHeaderSize();
+    d->maxHeaderCount = configuration.maxHeaderCount();
+}
 
-    if (handlingRequest)
-        disconnect(socket, &QIODevice::readyRead, this, &QHttpServerStream::handleReadyRead);
-    else if (socket->bytesAvailable() > 0)
-        QMetaObject::invokeMethod(socket, &QIODevice::readyRead, Qt::QueuedConnection);
+/*!
+    \internal
+
+    Returns the request object holding the request that was just read, and
+    puts an unused one in its place.
+*/
+std::unique_ptr<QHttpServerRequest> QHttpServerStream::takeRequest()
+{
+    std::unique_ptr<QHttpServerRequest> taken;
+    if (spareRequests.empty()) {
+        taken.reset(new QHttpServerRequest(initRequestFromSocket(tcpSocket)));
+        applyLimits(taken->d.get());
+    } else {
+        taken = std::move(spareRequests.back());
+        spareRequests.pop_back();
+    }
+    std::swap(taken->d, request.d);
+    return taken;
 }
 
 void QHttpServerStream::socketDisconnected()
 {
-    if (!handlingRequest)
+    armDeadline(Deadline::None);
+    writeDeadline.stop();
+    if (bodyExchange) {
+        bodyExchange->request->d->bodyDevice->abort();
+        finishStreamedBody();
+    }
+
+    // Nothing can be sent any more. Drop the bodies that wait for their
+    // turn, and end the transfers, which would otherwise wait for the
+    // socket forever.
+    for (Exchange &exchange : pipeline) {
+        exchange.output.clear();
+        exchange.bodyDevice.reset();
+        if (exchange.transferSource)
+            exchange.transferSource->deleteLater();
+        exchange.transferring = false;
+    }
+
+    // Responders that handlers still hold refer to their exchanges, which
+    // therefore stay until the responders are destroyed
+    while (!pipeline.empty() && pipeline.front().responderDone
+           && !pipeline.front().readingBody) {
+        pipeline.front().request->d->clear();
+        spareRequests.push_back(std::move(pipeline.front().request));
+        pipeline.pop_front();
+    }
+    if (pipeline.empty())
         deleteLater();
 }
 
+/*!
+    \internal
+
+    Starts the deadline for \a kind with the timeout of the configuration,
+    replacing the current one. Stops it for Deadline::None or if the
+    timeout is disabled.
+*/
+void QHttpServerStream::armDeadline(Deadline kind)
+{
+    pendingDeadline = kind;
+
+    std::chrono::milliseconds timeout{0};
+    switch (kind) {
+    case Deadline::None:
+        break;
+    case Deadline::Idle:
+        timeout = configuration.keepAliveTimeout();
+        break;
+    case Deadline::Header:
+        timeout = configuration.headerReadTimeout();
+        break;
+    case Deadline::Body:
+        timeout = configuration.bodyReadTimeout();
+        break;
+    }
+
+    if (timeout <= std::chrono::milliseconds::zero()) {
+        deadline.stop();
+        return;
+    }
+    deadline.start(deadlineWheel(), timeout);
+}
+
+/*!
+    \internal
+*/
+QHttpServerTimerWheel *QHttpServerStream::deadlineWheel()
+{
+    if (!timerWheel)
+        timerWheel = server->d_func()->timerWheel(worker);
+    return timerWheel;
+}
+
+/*!
+    \internal
+
+    Switches from the idle to the header deadline once the first bytes of a
+    request arrived. The header deadline is not extended by further data,
+    so a client cannot keep the connection by sending its headers slowly.
+    The body deadline is extended whenever a part of the body arrives.
+*/
+void QHttpServerStream::updateReadDeadline()
+{
+    using State = QHttpServerRequestPrivate::State;
+
+    switch (request.d->state) {
+    case State::NothingDone:
+    case State::ReadingRequestLine:
+    case State::ReadingHeader:
+        if (pendingDeadline != Deadline::Header && !request.d->headerBlock.isEmpty())
+            armDeadline(Deadline::Header);
+        break;
+    case State::ExpectContinue:
+    case State::ReadingData:
+        armDeadline(Deadline::Body);
+        break;
+    case State::AllDone:
+        if (pendingDeadline != Deadline::None)
+            armDeadline(Deadline::None);
+        break;
+    }
+}
+
+/*!
+    \internal
+*/
+void QHttpServerStream::deadlineExpired()
+{
+    static constexpr const char *names[] = { "", "keep-alive", "header read", "body read" };
+    qCDebug(lcHttpServerStream, "Closing connection: %s timeout",
+            names[int(pendingDeadline)]);
+    pendingDeadline = Deadline::None;
+    closeConnection();
+}
+
+/*!
+    \internal
+
+    Starts or extends the write deadline while the socket has data to
+    write, and stops it once everything is written.
+*/
+void QHttpServerStream::updateWriteDeadline()
+{
+    if (configuration.writeTimeout() <= std::chrono::milliseconds::zero())
+        return;
+    if (socket && socket->bytesToWrite() > 0)
+        armWriteDeadline();
+    else
+        writeDeadline.stop();
+}
+
+/*!
+    \internal
+
+    Starts or extends the write deadline, if there is a write timeout.
+*/
+void QHttpServerStream::armWriteDeadline()
+{
+    const std::chrono::milliseconds timeout = configuration.writeTimeout();
+    if (timeout > std::chrono::milliseconds::zero())
+        writeDeadline.start(deadlineWheel(), timeout);
+}
+
+/*!
+    \internal
+
+    The client stopped reading, drop the connection without waiting for
+    the pending data to be written.
+*/
+void QHttpServerStream::writeDeadlineExpired()
+{
+    qCDebug(lcHttpServerStream, "Aborting connection: write timeout");
+    if (tcpSocket)
+        tcpSocket->abort();
+#if QT_CONFIG(localserver)
+    else if (localSocket)
+        localSocket->abort();
+#endif
+}
+
+/*!
+    \internal
+
+    Closes the connection once the pending data is written.
+*/
+void QHttpServerStream::closeConnection()
+{
+    if (tcpSocket)
+        tcpSocket->disconnectFromHost();
+#if QT_CONFIG(localserver)
+    else if (localSocket)
+        localSocket->disconnectFromServer();
+#endif
+}
+
 QHttpServerRequest QHttpServerStream::initRequestFromSocket(QTcpSocket *tcpSocket)
 {
     if (tcpSocket) {
@@ -98,15 +524,18 @@ QHttpServerRequest QHttpServerStream::initRequestFromSocket(QTcpSocket *tcpSocke
     return QHttpServerRequest(QHostAddress::LocalHost, 0, QHostAddress::LocalHost, 0);
 }
 
-QHttpServerStream::QHttpServerStream(QAbstractHttpServer *server, QIODevice *socket)
-    : QObject(server),
+QHttpServerStream::QHttpServerStream(QAbstractHttpServer *server, QIODevice *socket,
+                                     QHttpServerWorker *worker)
+    : QObject(worker ? static_cast<QObject *>(worker) : server),
       server(server),
+      worker(worker),
       socket(socket),
       tcpSocket(qobject_cast<QTcpSocket *>(socket)),
 #if QT_CONFIG(localserver)
       localSocket(qobject_cast<QLocalSocket*>(socket)),
 #endif
-      request(initRequestFromSocket(tcpSocket))
+      request(initRequestFromSocket(tcpSocket)),
+      configuration(server->configuration())
 {
     socket->setParent(this);
 
@@ -121,44 +550,282 @@ QHttpServerStream::QHttpServerStream(QAbstractHttpServer *server, QIODevice *soc
         connect(localSocket, &QLocalSocket::disconnected, this, &QHttpServerStream::socketDisconnected);
 #endif
     }
+    if (configuration.writeTimeout() > std::chrono::milliseconds::zero())
+        connect(socket, &QIODevice::bytesWritten, this, &QHttpServerStream::updateWriteDeadline);
+
+    applyLimits(request.d.get());
+    armDeadline(Deadline::Idle);
 }
 
-void QHttpServerStream::write(const QByteArray &ba)
+QHttpServerStream::~QHttpServerStream()
 {
-    Q_ASSERT(QThread::currentThread() == thread());
-    socket->write(ba);
+    if (worker)
+        --worker->connectionCount;
+    --server->d_func()->connectionCount;
 }
 
-void QHttpServerStream::write(const char *body, qint64 size)
+void QHttpServerStream::write(Exchange *exchange, const char *body, qint64 size)
 {
     Q_ASSERT(QThread::currentThread() == thread());
+
+    if (exchange != &pipeline.front()) {
+        exchange->output.append(body, size);
+        return;
+    }
+
     socket->write(body, size);
+    updateWriteDeadline();
 }
 
-void QHttpServerStream::responderDestroyed()
+// Bodies up to this size are appended to the head of the response when
+// both have to go through the write buffer of the socket.
+static constexpr qint64 CoalescedBodySize = 4096;
+
+// Writes the status line and headers in \a head followed by the start of
+// the body. On a plain TCP socket with an empty write buffer both go to the
+// kernel in a single sendmsg() call, and only what it did not take is queued
+// in the socket. The body is never copied in that case.
+void QHttpServerStream::write(Exchange *exchange, QByteArray &&head, const char *body,
+                              qint64 size)
 {
     Q_ASSERT(QThread::currentThread() == thread());
-    Q_ASSERT(handlingRequest);
-    handlingRequest = false;
 
-    if (tcpSocket) {
-        if (tcpSocket->state() != QAbstractSocket::ConnectedState) {
-            deleteLater();
-        } else {
-            connect(tcpSocket, &QTcpSocket::readyRead, this, &QHttpServerStream::handleReadyRead);
-            QMetaObject::invokeMethod(tcpSocket, &QTcpSocket::readyRead, Qt::QueuedConnection);
+    if (exchange != &pipeline.front()) {
+        if (exchange->output.isEmpty())
+            exchange->output = std::move(head);
+        else
+            exchange->output.append(head);
+        exchange->output.append(body, size);
+        return;
+    }
+
+#if defined(Q_OS_UNIX)
+    if (size > 0 && tcpSocket && tcpSocket->metaObject() == &QTcpSocket::staticMetaObject
+        && tcpSocket->state() == QAbstractSocket::ConnectedState
+        && tcpSocket->bytesToWrite() == 0) {
+        iovec vector[2];
+        vector[0].iov_base = head.data();
+        vector[0].iov_len = size_t(head.size());
+        vector[1].iov_base = const_cast<char *>(body);
+        vector[1].iov_len = size_t(size);
+
+        msghdr message = {};
+        message.msg_iov = vector;
+        message.msg_iovlen = 2;
+
+        const qint64 written =
+                qt_safe_sendmsg(int(tcpSocket->socketDescriptor()), &message, 0);
+        if (written > 0) {
+            if (written < head.size()) {
+                socket->write(head.constData() + written, head.size() - written);
+                socket->write(body, size);
+            } else if (written < head.size() + size) {
+                const qint64 bodyWritten = written - head.size();
+                socket->write(body + bodyWritten, size - bodyWritten);
+            }
+            updateWriteDeadline();
+            return;
         }
+        // Nothing was sent: let the socket queue everything and report
+        // errors the usual way.
+    }
+#endif
+
+    if (size <= CoalescedBodySize) {
+        head.append(body, size);
+        socket->write(head);
+    } else {
+        socket->write(head);
+        socket->write(body, size);
+    }
+    updateWriteDeadline();
+}
+
+/*!
+    \internal
+
+    Streams the rest of the body of the response of \a exchange from
+    \a device once the earlier responses are sent. Takes ownership of
+    \a device.
+*/
+void QHttpServerStream::write(Exchange *exchange, QIODevice *device)
+{
+    Q_ASSERT(QThread::currentThread() == thread());
+
+    // A body that cannot be sent would keep the transfer waiting forever
+    if (!isConnected())
+        device->deleteLater();
+    else if (exchange != &pipeline.front())
+        queueTransfer(exchange, device);
+    else
+        startTransfer(exchange, device);
+}
+
+/*!
+    \internal
+
+    Keeps \a device to send the body of \a exchange from once the earlier
+    responses are sent. Whether a sequential \a device reaches the end of
+    its data in the meantime is recorded, as it signals that only once.
+*/
+void QHttpServerStream::queueTransfer(Exchange *exchange, QIODevice *device)
+{
+    connect(device, &QIODevice::readChannelFinished, this,
+            [this, sequence = exchange->sequence]() {
+                for (Exchange &queued : pipeline) {
+                    if (queued.sequence == sequence)
+                        queued.bodyFinished = true;
+                }
+            });
+    exchange->bodyDevice.reset(device);
+}
+
+/*!
+    \internal
+*/
+void QHttpServerStream::startTransfer(Exchange *exchange, QIODevice *device)
+{
+    exchange->transferring = true;
+    exchange->transferSource = device;
+    auto finished = [stream = QPointer(this), sequence = exchange->sequence]() {
+        if (stream)
+            stream->transferFinished(sequence);
+    };
+
+#if defined(Q_OS_LINUX)
+    // Files on disk go from the page cache straight to the socket, unless
+    // the data has to be framed or encrypted on the way
+    auto *file = qobject_cast<QFile *>(device);
+    const qintptr descriptor = plainSocketDescriptor();
+    if (!exchange->chunkedBody && file && file->handle() != -1 && descriptor != -1) {
+        // The socket does not see what sendfile() writes, so its
+        // bytesWritten() cannot extend the write deadline
+        auto progressed = [stream = QPointer(this)]() {
+            if (stream)
+                stream->armWriteDeadline();
+        };
+        QHttpServerResponderPrivate::sendFile(file, socket, descriptor, exchange->bodyLength,
+                                              std::move(progressed), std::move(finished));
+        return;
+    }
+#endif
+
+    QHttpServerResponderPrivate::transfer(device, socket, exchange->chunkedBody,
+                                          exchange->bodyLength, exchange->bodyFinished,
+                                          configuration.transferBufferSize(),
+                                          std::move(finished));
+}
+
+/*!
+    \internal
+
+    Returns the descriptor of the socket if data written to it goes to the
+    peer as it is, or -1 if the socket transforms it, as TLS does.
+*/
+qintptr QHttpServerStream::plainSocketDescriptor() const
+{
+    if (tcpSocket && tcpSocket->metaObject() == &QTcpSocket::staticMetaObject)
+        return tcpSocket->socketDescriptor();
 #if QT_CONFIG(localserver)
-    } else if (localSocket) {
-        if (localSocket->state() != QLocalSocket::ConnectedState) {
+    if (localSocket)
+        return localSocket->socketDescriptor();
+#endif
+    return -1;
+}
+
+/*!
+    \internal
+
+    Returns \c true while data written to the socket can reach the client.
+*/
+bool QHttpServerStream::isConnected() const
+{
+    if (tcpSocket)
+        return tcpSocket->state() == QAbstractSocket::ConnectedState;
+#if QT_CONFIG(localserver)
+    if (localSocket)
+        return localSocket->state() == QLocalSocket::ConnectedState;
+#endif
+    return false;
+}
+
+/*!
+    \internal
+*/
+void QHttpServerStream::transferFinished(quint64 sequence)
+{
+    if (pipeline.empty() || pipeline.front().sequence != sequence)
+        return;
+    pipeline.front().transferring = false;
+    // Stops the deadline a file sent with sendfile() armed
+    updateWriteDeadline();
+    advancePipeline();
+}
+
+void QHttpServerStream::responderDestroyed(Exchange *exchange)
+{
+    Q_ASSERT(QThread::currentThread() == thread());
+    Q_ASSERT(!exchange->responderDone);
+    exchange->responderDone = true;
+
+    // Skip the rest of a streamed body the handler did not read
+    if (exchange->readingBody)
+        QMetaObject::invokeMethod(this, &QHttpServerStream::handleReadyRead, Qt::QueuedConnection);
+
+    advancePipeline();
+}
+
+/*!
+    \internal
+
+    Removes the exchanges whose responses are completely written from the
+    front of the pipeline, and sends what the next one has written in the
+    meantime. Reading continues once the pipeline has room again.
+*/
+void QHttpServerStream::advancePipeline()
+{
+    bool advanced = false;
+    while (!pipeline.empty()) {
+        Exchange &front = pipeline.front();
+        if (!front.responderDone || front.transferring || front.readingBody)
+            break;
+
+        front.request->d->clear();
+        spareRequests.push_back(std::move(front.request));
+        pipeline.pop_front();
+        advanced = true;
+
+        if (pipeline.empty() || !socket)
+            break;
+
+        Exchange &next = pipeline.front();
+        if (!next.output.isEmpty()) {
+            socket->write(std::exchange(next.output, {}));
+            updateWriteDeadline();
+        }
+        if (next.bodyDevice)
+            startTransfer(&next, next.bodyDevice.release());
+    }
+
+    if (!advanced || !socket)
+        return;
+
+    if (!isConnected()) {
+        if (pipeline.empty())
             deleteLater();
-        } else {
-            connect(localSocket, &QLocalSocket::readyRead,
-                    this, &QHttpServerStream::handleReadyRead);
-            QMetaObject::invokeMethod(localSocket, &QLocalSocket::readyRead, Qt::QueuedConnection);
+        return;
+    }
+
+    if (pipeline.empty()) {
+        if (closeAfterResponse) {
+            closeConnection();
+            return;
         }
-#endif
+        armDeadline(Deadline::Idle);
     }
+
+    if (!closeAfterResponse && socket->bytesAvailable() > 0)
+        QMetaObject::invokeMethod(this, &QHttpServerStream::handleReadyRead, Qt::QueuedConnection);
 }
 
 QT_END_NAMESPACE
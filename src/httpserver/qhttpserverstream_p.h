@@ -4,11 +4,21 @@
 #ifndef QHTTPSERVERSTREAM_P_H
 #define QHTTPSERVERSTREAM_P_H
 
+#include <QtCore/qiodevice.h>
 #include <QtCore/qobject.h>
+#include <QtCore/qpointer.h>
+#include <QtCore/qscopedpointer.h>
 
 #include <QtHttpServer/qthttpserverglobal.h>
+#include <QtHttpServer/qhttpserverconfiguration.h>
 #include <QtHttpServer/qhttpserverrequest.h>
 
+#include <private/qhttpservertimerwheel_p.h>
+
+#include <deque>
+#include <memory>
+#include <vector>
+
 //
 //  W A R N I N G
 //  -------------
@@ -23,6 +33,7 @@ QT_BEGIN_NAMESPACE
 
 class QTcpSocket;
 class QAbstractHttpServer;
+class QHttpServerWorker;
 #if QT_CONFIG(localserver)
 class QLocalSocket;
 #endif
@@ -33,19 +44,80 @@ class QHttpServerStream : public QObject
 
     friend class QAbstractHttpServerPrivate;
     friend class QHttpServerResponder;
+    friend class QHttpServerResponderPrivate;
 
 private:
-    QHttpServerStream(QAbstractHttpServer *server, QIODevice *socket);
-
-    void write(const QByteArray &data);
-    void write(const char *body, qint64 size);
-
-    void responderDestroyed();
+    // A request that is being handled, and its response until it is
+    // completely written to the socket. Responses are written in the order
+    // of the requests: only the first exchange of the pipeline writes to
+    // the socket, the others keep their output until it is their turn.
+    struct Exchange
+    {
+        std::unique_ptr<QHttpServerRequest> request;
+        // Value of the Connection header of the response, if any
+        QByteArrayView connectionHeader;
+        // Data written while an earlier response was not sent yet
+        QByteArray output;
+        // Device to stream the rest of the body from, once output is sent
+        std::unique_ptr<QIODevice, QScopedPointerDeleteLater> bodyDevice;
+        // The body device emitted readChannelFinished() while it waited
+        bool bodyFinished = false;
+        quint64 sequence = 0;
+        bool responderDone = false;
+        bool transferring = false;
+        // The device the body is sent from while transferring. The transfer
+        // ends when it is deleted.
+        QPointer<QIODevice> transferSource;
+        // How much of the body device is sent, -1 for all of it
+        qint64 bodyLength = -1;
+        // The body device is sent with chunked transfer coding
+        bool chunkedBody = false;
+        // The body is streamed to the handler and not complete yet
+        bool readingBody = false;
+    };
+
+    QHttpServerStream(QAbstractHttpServer *server, QIODevice *socket,
+                      QHttpServerWorker *worker = nullptr);
+    ~QHttpServerStream() override;
+
+    void write(Exchange *exchange, const char *body, qint64 size);
+    void write(Exchange *exchange, QByteArray &&head, const char *body, qint64 size);
+    void write(Exchange *exchange, QIODevice *device);
+    void queueTransfer(Exchange *exchange, QIODevice *device);
+    void startTransfer(Exchange *exchange, QIODevice *device);
+    qintptr plainSocketDescriptor() const;
+    bool isConnected() const;
+    void transferFinished(quint64 sequence);
+
+    void responderDestroyed(Exchange *exchange);
+    void advancePipeline();
+    void applyLimits(QHttpServerRequestPrivate *d) const;
+    std::unique_ptr<QHttpServerRequest> takeRequest();
 
     void handleReadyRead();
+    void rejectRequest();
+    bool handleRequest(bool streamBody);
+    bool readStreamedBody();
+    void finishStreamedBody();
     void socketDisconnected();
 
+    enum class Deadline {
+        None,
+        Idle,
+        Header,
+        Body,
+    };
+    void armDeadline(Deadline kind);
+    void updateReadDeadline();
+    void deadlineExpired();
+    void updateWriteDeadline();
+    void armWriteDeadline();
+    void writeDeadlineExpired();
+    void closeConnection();
+    QHttpServerTimerWheel *deadlineWheel();
+
     QAbstractHttpServer *server;
+    QHttpServerWorker *worker;
     QIODevice *socket;
     QTcpSocket *tcpSocket;
 #if QT_CONFIG(localserver)
@@ -54,11 +126,32 @@ private:
 
     static QHttpServerRequest initRequestFromSocket(QTcpSocket *socket);
 
+    // The request being read
     QHttpServerRequest request;
 
-    // To avoid destroying the object when socket object is destroyed while
-    // a request is still being handled.
-    bool handlingRequest = false;
+    // Copied from the server when the connection is accepted
+    const QHttpServerConfiguration configuration;
+
+    // The requests being handled, oldest first. The stream is not destroyed
+    // with its socket while handlers still hold responders for them.
+    std::deque<Exchange> pipeline;
+    quint64 nextSequence = 0;
+    // The exchange whose body is being read
+    Exchange *bodyExchange = nullptr;
+    // Request objects of finished exchanges, to reuse their buffers
+    std::vector<std::unique_ptr<QHttpServerRequest>> spareRequests;
+
+    // What the connection is waiting for, and the deadline for it
+    Deadline pendingDeadline = Deadline::None;
+    QHttpServerTimerWheel *timerWheel = nullptr;
+    QHttpServerTimerWheel::Timer deadline{[this] { deadlineExpired(); }};
+    // Runs while the client does not read the data written to it
+    QHttpServerTimerWheel::Timer writeDeadline{[this] { writeDeadlineExpired(); }};
+
+    int requestCount = 0;
+    // Set when no more requests are read, and the connection is closed
+    // after the pending responses
+    bool closeAfterResponse = false;
 };
 
 QT_END_NAMESPACE
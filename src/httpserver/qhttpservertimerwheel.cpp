@@ -0,0 +1,180 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "qhttpservertimerwheel_p.h"
+
+#include <QtCore/qcoreevent.h>
+
+#include <utility>
+
+QT_BEGIN_NAMESPACE
+
+// A hashed timing wheel: the timers are kept in intrusive lists, one per
+// slot, and a timer due at tick n is put into slot n modulo the number of
+// slots. When the wheel reaches a slot, the timers that are due expire and
+// the others, due in a later turn or pushed back since they were inserted,
+// are moved to the slot of their due tick. A single coarse timer advances
+// the wheel, and only runs while timers are active. This replaces a QTimer
+// per connection, which would cost a timer registration with the event
+// dispatcher for every (re)start.
+//
+// Deadlines that are re-armed on every bit of activity are mostly pushed
+// back, which only updates the due tick of the timer. It is moved to
+// another slot at most once per expiry of the slot it is in.
+
+/*!
+    \internal
+
+    Starts or restarts this timer, to call its callback after \a timeout
+    from the event loop of the thread of \a newWheel.
+*/
+void QHttpServerTimerWheel::Timer::start(QHttpServerTimerWheel *newWheel,
+                                         std::chrono::milliseconds timeout)
+{
+    const qint64 newDue = newWheel->dueTick(timeout);
+    if (wheel == newWheel && newDue >= due) {
+        // Checked again when the slot of the old due tick is reached
+        due = newDue;
+        return;
+    }
+    stop();
+    newWheel->insert(this, newDue);
+}
+
+/*!
+    \internal
+*/
+void QHttpServerTimerWheel::Timer::stop()
+{
+    if (wheel)
+        wheel->remove(this);
+}
+
+/*!
+    \internal
+*/
+QHttpServerTimerWheel::QHttpServerTimerWheel() = default;
+
+/*!
+    \internal
+*/
+QHttpServerTimerWheel::~QHttpServerTimerWheel()
+{
+    for (Timer *&first : slots) {
+        while (first)
+            remove(first);
+    }
+}
+
+/*!
+    \internal
+*/
+QHttpServerTimerWheel::Timer *&QHttpServerTimerWheel::head(qsizetype slot)
+{
+    return slot == ExpiringSlot ? expiring : slots[slot];
+}
+
+/*!
+    \internal
+
+    Returns the tick at which a timer started now with \a timeout expires.
+*/
+qint64 QHttpServerTimerWheel::dueTick(std::chrono::milliseconds timeout) const
+{
+    // The current tick has partly passed already, so one more tick is added
+    // to never expire a timer early
+    return currentTick + (timeout + Tick - std::chrono::milliseconds(1)) / Tick + 1;
+}
+
+/*!
+    \internal
+*/
+void QHttpServerTimerWheel::insert(Timer *timer, qint64 due)
+{
+    Q_ASSERT(!timer->wheel);
+    Q_ASSERT(due > currentTick);
+
+    if (!ticker.isActive()) {
+        clock.start();
+        elapsedTicks = 0;
+        ticker.start(Tick, Qt::CoarseTimer, this);
+    }
+    ++activeCount;
+
+    timer->wheel = this;
+    timer->due = due;
+    timer->slot = due % SlotCount;
+    timer->previous = nullptr;
+    timer->next = slots[timer->slot];
+    if (timer->next)
+        timer->next->previous = timer;
+    slots[timer->slot] = timer;
+}
+
+/*!
+    \internal
+*/
+void QHttpServerTimerWheel::remove(Timer *timer)
+{
+    Q_ASSERT(timer->wheel == this);
+
+    if (timer->previous)
+        timer->previous->next = timer->next;
+    else
+        head(timer->slot) = timer->next;
+    if (timer->next)
+        timer->next->previous = timer->previous;
+    timer->previous = nullptr;
+    timer->next = nullptr;
+    timer->wheel = nullptr;
+    --activeCount;
+}
+
+/*!
+    \internal
+
+    Moves the wheel one slot ahead and expires the timers of that slot.
+*/
+void QHttpServerTimerWheel::advance()
+{
+    ++currentTick;
+
+    // Detach the slot first: callbacks may stop or start any timer,
+    // including the ones of this slot.
+    expiring = std::exchange(slots[currentTick % SlotCount], nullptr);
+    for (Timer *timer = expiring; timer; timer = timer->next)
+        timer->slot = ExpiringSlot;
+
+    while (Timer *timer = expiring) {
+        const qint64 due = timer->due;
+        remove(timer);
+        if (due > currentTick) {
+            // Due in a later turn of the wheel, or pushed back
+            insert(timer, due);
+            continue;
+        }
+        timer->callback();
+    }
+}
+
+/*!
+    \internal
+*/
+void QHttpServerTimerWheel::timerEvent(QTimerEvent *event)
+{
+    if (event->timerId() != ticker.timerId()) {
+        QObject::timerEvent(event);
+        return;
+    }
+
+    const qint64 ticks = clock.elapsed() / Tick.count();
+    while (elapsedTicks < ticks && activeCount > 0) {
+        ++elapsedTicks;
+        advance();
+    }
+
+    if (activeCount == 0)
+        ticker.stop();
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,92 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef QHTTPSERVERTIMERWHEEL_P_H
+#define QHTTPSERVERTIMERWHEEL_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists for the convenience
+// of QHttpServer. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+
+#include <QtHttpServer/qthttpserverglobal.h>
+
+#include <QtCore/qbasictimer.h>
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qobject.h>
+
+#include <array>
+#include <chrono>
+#include <functional>
+
+QT_BEGIN_NAMESPACE
+
+class QHttpServerTimerWheel : public QObject
+{
+public:
+    // A deadline registered with a wheel. Starting, restarting and
+    // stopping it are constant time operations. Pushing the deadline of an
+    // active timer further out only records the new due tick.
+    class Timer
+    {
+    public:
+        explicit Timer(std::function<void()> callback) : callback(std::move(callback)) { }
+        ~Timer() { stop(); }
+
+        Q_DISABLE_COPY_MOVE(Timer)
+
+        void start(QHttpServerTimerWheel *wheel, std::chrono::milliseconds timeout);
+        void stop();
+        bool isActive() const { return wheel != nullptr; }
+
+    private:
+        friend class QHttpServerTimerWheel;
+
+        std::function<void()> callback;
+        QHttpServerTimerWheel *wheel = nullptr;
+        Timer *previous = nullptr;
+        Timer *next = nullptr;
+        qsizetype slot = 0;
+        // Tick at which the timer expires
+        qint64 due = 0;
+    };
+
+    static constexpr std::chrono::milliseconds Tick{100};
+    static constexpr qsizetype SlotCount = 512;
+
+    QHttpServerTimerWheel();
+    ~QHttpServerTimerWheel() override;
+
+protected:
+    void timerEvent(QTimerEvent *event) override;
+
+private:
+    static constexpr qsizetype ExpiringSlot = -1;
+
+    qint64 dueTick(std::chrono::milliseconds timeout) const;
+    void insert(Timer *timer, qint64 due);
+    void remove(Timer *timer);
+    Timer *&head(qsizetype slot);
+    void advance();
+
+    std::array<Timer *, SlotCount> slots = {};
+    // The timers of the slot whose timers are being expired
+    Timer *expiring = nullptr;
+    qint64 currentTick = 0;
+    qint64 activeCount = 0;
+
+    // Time of the last tick, so that late timer events still expire
+    // every slot they passed
+    QElapsedTimer clock;
+    qint64 elapsedTicks = 0;
+    QBasicTimer ticker;
+};
+
+QT_END_NAMESPACE
+
+#endif // QHTTPSERVERTIMERWHEEL_P_H
@@ -10,7 +10,11 @@
 #include <QtTest/qsignalspy.h>
 #include <QtTest/qtest.h>
 
+#include <QtCore/qbuffer.h>
+#include <QtCore/qfile.h>
 #include <QtCore/qregularexpression.h>
+#include <QtCore/qtemporarydir.h>
+#include <QtCore/qthread.h>
 #include <QtCore/qurl.h>
 #include <QtNetwork/qnetworkaccessmanager.h>
 #include <QtNetwork/qnetworkreply.h>
@@ -20,6 +24,11 @@
 #include <QtHttpServer/qhttpserverrequest.h>
 #include <QtHttpServer/qhttpserverresponder.h>
 
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <vector>
+
 QT_BEGIN_NAMESPACE
 
 using namespace Qt::StringLiterals;
@@ -35,6 +44,25 @@ private slots:
     void websocket();
     void servers();
     void qtbug82053();
+    void fragmentedRequest_data();
+    void fragmentedRequest();
+    void chunkedBody_data();
+    void chunkedBody();
+    void requestViews_data();
+    void requestViews();
+    void malformedHeader_data();
+    void malformedHeader();
+    void workerThreads();
+    void listenSharded();
+    void dateAndServerHeaders();
+    void connectionPolicy();
+    void pipelining();
+    void requestLimits_data();
+    void requestLimits();
+    void sequentialBody();
+    void transferFlowControl();
+    void disconnectDuringTransfer_data();
+    void disconnectDuringTransfer();
 };
 
 void tst_QAbstractHttpServer::request_data()
@@ -224,6 +252,998 @@ void tst_QAbstractHttpServer::qtbug82053()
     QTRY_VERIFY(server.wasConnectRequest);
 }
 
+void tst_QAbstractHttpServer::fragmentedRequest_data()
+{
+    QTest::addColumn<QByteArrayList>("fragments");
+
+    QTest::addRow("single")
+            << QByteArrayList{ "GET /path HTTP/1.1\r\nHost: localhost\r\nX-Test: value\r\n\r\n" };
+    QTest::addRow("split request line")
+            << QByteArrayList{ "GET /pa", "th HTTP/1.1\r", "\nHost: localhost\r\nX-Test: value\r\n\r\n" };
+    QTest::addRow("split header terminator")
+            << QByteArrayList{ "GET /path HTTP/1.1\r\nHost: localhost\r\nX-Test: value\r\n",
+                               "\r", "\n" };
+    QTest::addRow("split header")
+            << QByteArrayList{ "GET /path HTTP/1.1\r\nHost: loc", "alhost\r\nX-Te",
+                               "st: value\r\n\r\n" };
+    QTest::addRow("leading whitespace")
+            << QByteArrayList{ "\r\n", "\r\nGET /path HTTP/1.1\nHost: localhost\nX-Test: value\n\n" };
+    QTest::addRow("long headers")
+            << QByteArrayList{ "GET /path HTTP/1.1\r\nHost: localhost\r\nCookie: "
+                               + QByteArray(1000, 'c') + "\r\nX-Trace: " + QByteArray(70, 't'),
+                               "\r\nX-Test: \t value \t\r\n\r\n" };
+}
+
+void tst_QAbstractHttpServer::requestViews_data()
+{
+    QTest::addColumn<QByteArray>("target");
+    QTest::addColumn<QByteArray>("path");
+    QTest::addColumn<QByteArray>("query");
+
+    QTest::addRow("root") << QByteArray("/") << QByteArray("/") << QByteArray();
+    QTest::addRow("query") << QByteArray("/a%20b?x=1&y=2") << QByteArray("/a%20b")
+                           << QByteArray("x=1&y=2");
+    QTest::addRow("empty query") << QByteArray("/path?") << QByteArray("/path") << QByteArray();
+    QTest::addRow("absolute form") << QByteArray("http://localhost:1234/abs?q")
+                                   << QByteArray("/abs") << QByteArray("q");
+}
+
+void tst_QAbstractHttpServer::requestViews()
+{
+    QFETCH(QByteArray, target);
+    QFETCH(QByteArray, path);
+    QFETCH(QByteArray, query);
+
+    struct HttpServer : QAbstractHttpServer
+    {
+        QByteArray path;
+        QByteArray query;
+        QByteArray trace;
+        QByteArray accept;
+        bool missingIsNull = false;
+        QList<QPair<QByteArray, QByteArray>> headers;
+
+        bool handleRequest(const QHttpServerRequest &request, QHttpServerResponder &responder) override
+        {
+            path = request.pathView().toByteArray();
+            query = request.queryView().toByteArray();
+            trace = request.headerView("x-trace").toByteArray();
+            accept = request.value("accept");
+            missingIsNull = request.headerView("x-missing").isNull();
+            headers = request.headers();
+            responder.write(QHttpServerResponder::StatusCode::Ok);
+            return true;
+        }
+
+        void missingHandler(const QHttpServerRequest &, QHttpServerResponder &&) override
+        {
+            Q_ASSERT(false);
+        }
+    } server;
+    auto tcpServer = new QTcpServer;
+    QVERIFY(tcpServer->listen());
+    server.bind(tcpServer);
+
+    QTcpSocket client;
+    client.connectToHost(QHostAddress::LocalHost, tcpServer->serverPort());
+    QVERIFY(client.waitForConnected());
+    client.write("GET " + target + " HTTP/1.1\r\nHost: localhost\r\nX-Trace: abc\r\n"
+                 "Accept: text/html\r\naccept: text/plain\r\n\r\n");
+    QTRY_VERIFY(client.bytesAvailable() > 0);
+
+    QCOMPARE(server.path, path);
+    QCOMPARE(server.query, query);
+    QCOMPARE(server.trace, "abc");
+    QCOMPARE(server.accept, "text/html, text/plain");
+    QVERIFY(server.missingIsNull);
+    QCOMPARE(server.headers.size(), 4);
+    QCOMPARE(server.headers.at(1), qMakePair(QByteArray("X-Trace"), QByteArray("abc")));
+}
+
+void tst_QAbstractHttpServer::malformedHeader_data()
+{
+    QTest::addColumn<QByteArray>("header");
+
+    QTest::addRow("obsolete line folding") << QByteArray("X-Test: first\r\n second\r\n");
+    QTest::addRow("whitespace before colon") << QByteArray("X-Test : value\r\n");
+    QTest::addRow("missing colon") << QByteArray("X-Test value\r\n");
+    QTest::addRow("empty name") << QByteArray(": value\r\n");
+}
+
+void tst_QAbstractHttpServer::malformedHeader()
+{
+    QFETCH(QByteArray, header);
+
+    struct HttpServer : QAbstractHttpServer
+    {
+        bool handled = false;
+
+        bool handleRequest(const QHttpServerRequest &, QHttpServerResponder &responder) override
+        {
+            handled = true;
+            responder.write(QHttpServerResponder::StatusCode::Ok);
+            return true;
+        }
+
+        void missingHandler(const QHttpServerRequest &, QHttpServerResponder &&) override
+        {
+            Q_ASSERT(false);
+        }
+    } server;
+    auto tcpServer = new QTcpServer;
+    QVERIFY(tcpServer->listen());
+    server.bind(tcpServer);
+
+    QTcpSocket client;
+    client.connectToHost(QHostAddress::LocalHost, tcpServer->serverPort());
+    QVERIFY(client.waitForConnected());
+    client.write("GET / HTTP/1.1\r\nHost: localhost\r\n" + header + "\r\n");
+    QTRY_COMPARE(client.state(), QAbstractSocket::UnconnectedState);
+    QVERIFY(!server.handled);
+}
+
+void tst_QAbstractHttpServer::fragmentedRequest()
+{
+    QFETCH(QByteArrayList, fragments);
+
+    struct HttpServer : QAbstractHttpServer
+    {
+        QString path;
+        QByteArray value;
+
+        bool handleRequest(const QHttpServerRequest &request, QHttpServerResponder &responder) override
+        {
+            path = request.url().path();
+            value = request.value("x-test");
+            responder.write(QHttpServerResponder::StatusCode::Ok);
+            return true;
+        }
+
+        void missingHandler(const QHttpServerRequest &, QHttpServerResponder &&) override
+        {
+            Q_ASSERT(false);
+        }
+    } server;
+    auto tcpServer = new QTcpServer;
+    QVERIFY(tcpServer->listen());
+    server.bind(tcpServer);
+
+    QTcpSocket client;
+    client.connectToHost(QHostAddress::LocalHost, tcpServer->serverPort());
+    QVERIFY(client.waitForConnected());
+    for (const QByteArray &fragment : std::as_const(fragments)) {
+        QVERIFY(server.path.isEmpty());
+        client.write(fragment);
+        QVERIFY(client.waitForBytesWritten());
+        QTest::qWait(20);
+    }
+
+    QTRY_COMPARE(server.path, u"/path"_s);
+    QCOMPARE(server.value, "value");
+    QTRY_VERIFY(client.bytesAvailable() > 0);
+    QVERIFY(client.readAll().startsWith("HTTP/1.1 200 OK\r\n"));
+}
+
+void tst_QAbstractHttpServer::chunkedBody_data()
+{
+    QTest::addColumn<QByteArrayList>("fragments");
+    QTest::addColumn<QByteArray>("body");
+
+    const QByteArray head = "POST / HTTP/1.1\r\nHost: localhost\r\n"
+                            "Transfer-Encoding: chunked\r\n\r\n";
+
+    QTest::addRow("single chunk")
+            << QByteArrayList{ head + "5\r\nhello\r\n0\r\n\r\n" } << QByteArray("hello");
+    QTest::addRow("split crlf")
+            << QByteArrayList{ head + "5\r", "\nhel", "lo\r", "\n", "6\r\n world\r\n0\r", "\n\r",
+                               "\n" }
+            << QByteArray("hello world");
+    QTest::addRow("split size")
+            << QByteArrayList{ head + "1", "0\r\n0123456789abcdef\r\n0\r\n\r\n" }
+            << QByteArray("0123456789abcdef");
+    QTest::addRow("extensions")
+            << QByteArrayList{ head + "5;name=\"va;lue\"\r\nhello\r\n0;last\r\n\r\n" }
+            << QByteArray("hello");
+    QTest::addRow("trailers")
+            << QByteArrayList{ head + "5\r\nhello\r\n0\r\nX-Checksum: 1234\r\nX-Ot",
+                               "her: value\r\n\r\n" }
+            << QByteArray("hello");
+    QTest::addRow("bare line feeds")
+            << QByteArrayList{ head + "5\nhello\n0\n\n" } << QByteArray("hello");
+
+    QByteArray chunks;
+    QByteArray body;
+    for (int i = 0; i < 1000; ++i) {
+        const QByteArray data = QByteArray::number(i);
+        chunks += QByteArray::number(data.size(), 16) + "\r\n" + data + "\r\n";
+        body += data;
+    }
+    QTest::addRow("many small chunks") << QByteArrayList{ head + chunks + "0\r\n\r\n" } << body;
+
+    const QByteArray large(100000, 'x');
+    QTest::addRow("large chunk")
+            << QByteArrayList{ head + QByteArray::number(large.size(), 16) + "\r\n"
+                                       + large.first(50000),
+                               large.sliced(50000) + "\r\n0\r\n\r\n" }
+            << large;
+}
+
+void tst_QAbstractHttpServer::chunkedBody()
+{
+    QFETCH(QByteArrayList, fragments);
+    QFETCH(QByteArray, body);
+
+    struct HttpServer : QAbstractHttpServer
+    {
+        QByteArrayList bodies;
+
+        bool handleRequest(const QHttpServerRequest &request,
+                           QHttpServerResponder &responder) override
+        {
+            bodies.append(request.body());
+            responder.write(QHttpServerResponder::StatusCode::Ok);
+            return true;
+        }
+
+        void missingHandler(const QHttpServerRequest &, QHttpServerResponder &&) override
+        {
+            Q_ASSERT(false);
+        }
+    } server;
+    auto tcpServer = new QTcpServer;
+    QVERIFY(tcpServer->listen());
+    server.bind(tcpServer);
+
+    QTcpSocket client;
+    client.connectToHost(QHostAddress::LocalHost, tcpServer->serverPort());
+    QVERIFY(client.waitForConnected());
+    for (const QByteArray &fragment : std::as_const(fragments)) {
+        client.write(fragment);
+        QVERIFY(client.waitForBytesWritten());
+        QTest::qWait(20);
+    }
+
+    // The body ends exactly where it should, the next request is read
+    client.write("GET / HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    QTRY_COMPARE(server.bodies.size(), 2);
+    QCOMPARE(server.bodies.first(), body);
+    QVERIFY(server.bodies.last().isEmpty());
+}
+
+void tst_QAbstractHttpServer::workerThreads()
+{
+    struct HttpServer : QAbstractHttpServer
+    {
+        std::atomic<QThread *> requestThread = nullptr;
+
+        ~HttpServer() override { setWorkerThreadCount(0); }
+
+        bool handleRequest(const QHttpServerRequest &, QHttpServerResponder &responder) override
+        {
+            requestThread = QThread::currentThread();
+            responder.write(QHttpServerResponder::StatusCode::Ok);
+            return true;
+        }
+
+        void missingHandler(const QHttpServerRequest &, QHttpServerResponder &&) override
+        {
+            Q_ASSERT(false);
+        }
+    } server;
+
+    QCOMPARE(server.workerThreadCount(), 0);
+    server.setWorkerThreadCount(2);
+    QCOMPARE(server.workerThreadCount(), 2);
+
+    auto tcpServer = new QTcpServer;
+    QVERIFY(tcpServer->listen());
+    server.bind(tcpServer);
+
+    QTcpSocket client;
+    client.connectToHost(QHostAddress::LocalHost, tcpServer->serverPort());
+    QVERIFY(client.waitForConnected());
+    client.write("GET / HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    QTRY_VERIFY(client.bytesAvailable() > 0);
+    QVERIFY(client.readAll().startsWith("HTTP/1.1 200 OK\r\n"));
+
+    QThread *requestThread = server.requestThread;
+    QVERIFY(requestThread);
+    QCOMPARE_NE(requestThread, QThread::currentThread());
+
+    server.setWorkerThreadCount(0);
+    QCOMPARE(server.workerThreadCount(), 0);
+}
+
+void tst_QAbstractHttpServer::listenSharded()
+{
+    struct HttpServer : QAbstractHttpServer
+    {
+        std::atomic<int> requestCount = 0;
+
+        ~HttpServer() override { setWorkerThreadCount(0); }
+
+        bool handleRequest(const QHttpServerRequest &, QHttpServerResponder &responder) override
+        {
+            ++requestCount;
+            responder.write(QHttpServerResponder::StatusCode::Ok);
+            return true;
+        }
+
+        void missingHandler(const QHttpServerRequest &, QHttpServerResponder &&) override
+        {
+            Q_ASSERT(false);
+        }
+    } server;
+
+    server.setWorkerThreadCount(3);
+    const quint16 port = server.listenSharded(QHostAddress::LocalHost);
+    QVERIFY(port);
+    for (quint16 serverPort : server.serverPorts())
+        QCOMPARE(serverPort, port);
+
+    constexpr int ClientCount = 10;
+    for (int i = 0; i < ClientCount; ++i) {
+        QTcpSocket client;
+        client.connectToHost(QHostAddress::LocalHost, port);
+        QVERIFY(client.waitForConnected());
+        client.write("GET / HTTP/1.1\r\nHost: localhost\r\n\r\n");
+        QTRY_VERIFY(client.bytesAvailable() > 0);
+        QVERIFY(client.readAll().startsWith("HTTP/1.1 200 OK\r\n"));
+    }
+    QCOMPARE(server.requestCount, ClientCount);
+
+    server.setWorkerThreadCount(0);
+    QVERIFY(server.servers().isEmpty());
+}
+
+void tst_QAbstractHttpServer::dateAndServerHeaders()
+{
+    struct HttpServer : QAbstractHttpServer
+    {
+        bool handleRequest(const QHttpServerRequest &request,
+                           QHttpServerResponder &responder) override
+        {
+            if (request.url().path() == "/own-server"_L1) {
+                responder.write({{ "Server"_ba, "handler"_ba }});
+            } else if (request.url().path() == "/head-only"_L1) {
+                // The head is flushed when the responder is destroyed
+                responder.writeStatusLine(QHttpServerResponder::StatusCode::NoContent);
+                responder.writeHeader("Cache-Control"_ba, "no-store"_ba);
+            } else {
+                responder.write(QHttpServerResponder::StatusCode::Ok);
+            }
+            return true;
+        }
+
+        void missingHandler(const QHttpServerRequest &, QHttpServerResponder &&) override
+        {
+            Q_ASSERT(false);
+        }
+    } server;
+
+    QVERIFY(!server.configuration().isDateHeaderEnabled());
+    QVERIFY(server.configuration().serverHeader().isEmpty());
+
+    QHttpServerConfiguration configuration;
+    configuration.setDateHeaderEnabled(true);
+    configuration.setServerHeader("test server"_ba);
+    server.setConfiguration(configuration);
+    QVERIFY(server.configuration().isDateHeaderEnabled());
+    QCOMPARE(server.configuration().serverHeader(), "test server"_ba);
+
+    auto tcpServer = new QTcpServer;
+    QVERIFY(tcpServer->listen());
+    server.bind(tcpServer);
+
+    QTcpSocket client;
+    client.connectToHost(QHostAddress::LocalHost, tcpServer->serverPort());
+    QVERIFY(client.waitForConnected());
+    client.write("GET / HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    QByteArray response;
+    QTRY_VERIFY((response += client.readAll()).contains("\r\n\r\n"));
+
+    QVERIFY(response.startsWith("HTTP/1.1 200 OK\r\n"));
+    QVERIFY(response.contains("\r\nServer: test server\r\n"));
+    const QRegularExpression date(
+            u"\r\nDate: (Mon|Tue|Wed|Thu|Fri|Sat|Sun), \\d\\d "
+            "(Jan|Feb|Mar|Apr|May|Jun|Jul|Aug|Sep|Oct|Nov|Dec) \\d{4} "
+            "\\d\\d:\\d\\d:\\d\\d GMT\r\n"_s);
+    QVERIFY(date.match(QString::fromLatin1(response)).hasMatch());
+
+    client.write("GET /own-server HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    response.clear();
+    QTRY_VERIFY((response += client.readAll()).contains("\r\n\r\n"));
+
+    QVERIFY(response.contains("\r\nServer: handler\r\n"));
+    QVERIFY(!response.contains("test server"));
+
+    client.write("GET /head-only HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    response.clear();
+    QTRY_VERIFY((response += client.readAll()).contains("\r\n\r\n"));
+
+    QVERIFY(response.startsWith("HTTP/1.1 204 No Content\r\n"));
+    QVERIFY(response.contains("\r\nCache-Control: no-store\r\n"));
+    QVERIFY(response.contains("\r\nServer: test server\r\n"));
+    QVERIFY(date.match(QString::fromLatin1(response)).hasMatch());
+    QVERIFY(response.endsWith("\r\n\r\n"));
+}
+
+void tst_QAbstractHttpServer::connectionPolicy()
+{
+    struct HttpServer : QAbstractHttpServer
+    {
+        bool handleRequest(const QHttpServerRequest &,
+                           QHttpServerResponder &responder) override
+        {
+            responder.write(QHttpServerResponder::StatusCode::Ok);
+            return true;
+        }
+
+        void missingHandler(const QHttpServerRequest &, QHttpServerResponder &&) override
+        {
+            Q_ASSERT(false);
+        }
+    } server;
+
+    using namespace std::chrono_literals;
+    QHttpServerConfiguration configuration;
+    configuration.setKeepAliveTimeout(300ms);
+    configuration.setHeaderReadTimeout(300ms);
+    configuration.setBodyReadTimeout(300ms);
+    configuration.setMaxRequestsPerConnection(2);
+    configuration.setMaxConnections(2);
+    server.setConfiguration(configuration);
+
+    auto tcpServer = new QTcpServer;
+    QVERIFY(tcpServer->listen());
+    server.bind(tcpServer);
+
+    // The second request is the last one of the connection
+    {
+        QTcpSocket client;
+        client.connectToHost(QHostAddress::LocalHost, tcpServer->serverPort());
+        QVERIFY(client.waitForConnected());
+        client.write("GET / HTTP/1.1\r\nHost: localhost\r\n\r\n");
+        QByteArray response;
+        QTRY_VERIFY((response += client.readAll()).contains("\r\n\r\n"));
+        QVERIFY(!response.contains("Connection:"));
+
+        // Only two connections are accepted at a time
+        QTcpSocket second;
+        second.connectToHost(QHostAddress::LocalHost, tcpServer->serverPort());
+        QVERIFY(second.waitForConnected());
+        QTcpSocket third;
+        third.connectToHost(QHostAddress::LocalHost, tcpServer->serverPort());
+        QVERIFY(third.waitForConnected());
+        QTRY_COMPARE(third.state(), QAbstractSocket::UnconnectedState);
+        QCOMPARE(second.state(), QAbstractSocket::ConnectedState);
+        second.abort();
+
+        client.write("GET / HTTP/1.1\r\nHost: localhost\r\n\r\n");
+        response.clear();
+        QTRY_VERIFY((response += client.readAll()).contains("\r\n\r\n"));
+        QVERIFY(response.contains("\r\nConnection: close\r\n"));
+        QTRY_COMPARE(client.state(), QAbstractSocket::UnconnectedState);
+    }
+
+    // The client asks to close the connection
+    {
+        QTcpSocket client;
+        client.connectToHost(QHostAddress::LocalHost, tcpServer->serverPort());
+        QVERIFY(client.waitForConnected());
+        client.write("GET / HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n");
+        QByteArray response;
+        QTRY_VERIFY((response += client.readAll()).contains("\r\n\r\n"));
+        QVERIFY(response.contains("\r\nConnection: close\r\n"));
+        QTRY_COMPARE(client.state(), QAbstractSocket::UnconnectedState);
+    }
+
+    // HTTP/1.0 connections are kept only on request
+    {
+        QTcpSocket client;
+        client.connectToHost(QHostAddress::LocalHost, tcpServer->serverPort());
+        QVERIFY(client.waitForConnected());
+        client.write("GET / HTTP/1.0\r\nConnection: keep-alive\r\n\r\n");
+        QByteArray response;
+        QTRY_VERIFY((response += client.readAll()).contains("\r\n\r\n"));
+        QVERIFY(response.contains("\r\nConnection: keep-alive\r\n"));
+        QCOMPARE(client.state(), QAbstractSocket::ConnectedState);
+
+        // Closed after the keep-alive timeout
+        QTRY_COMPARE(client.state(), QAbstractSocket::UnconnectedState);
+    }
+
+    // Headers sent too slowly
+    {
+        QTcpSocket client;
+        client.connectToHost(QHostAddress::LocalHost, tcpServer->serverPort());
+        QVERIFY(client.waitForConnected());
+        client.write("GET / HTTP/1.1\r\n");
+        QTest::qWait(200);
+        client.write("Host: localhost\r\n");
+        QTRY_COMPARE(client.state(), QAbstractSocket::UnconnectedState);
+        QVERIFY(client.readAll().isEmpty());
+    }
+
+    // The body deadline is extended while data arrives
+    {
+        QTcpSocket client;
+        client.connectToHost(QHostAddress::LocalHost, tcpServer->serverPort());
+        QVERIFY(client.waitForConnected());
+        client.write("POST / HTTP/1.1\r\nHost: localhost\r\nContent-Length: 6\r\n\r\n");
+        for (int i = 0; i < 3; ++i) {
+            QTest::qWait(200);
+            client.write("a");
+        }
+        QCOMPARE(client.state(), QAbstractSocket::ConnectedState);
+        QTRY_COMPARE(client.state(), QAbstractSocket::UnconnectedState);
+        QVERIFY(client.readAll().isEmpty());
+    }
+}
+
+void tst_QAbstractHttpServer::pipelining()
+{
+    struct HttpServer : QAbstractHttpServer
+    {
+        std::vector<QHttpServerResponder> delayed;
+        QStringList handled;
+
+        bool handleRequest(const QHttpServerRequest &request,
+                           QHttpServerResponder &responder) override
+        {
+            handled.append(request.url().path());
+            if (request.url().path() == "/slow"_L1)
+                delayed.push_back(std::move(responder));
+            else
+                responder.write(request.url().path().toUtf8(), "text/plain"_ba);
+            return true;
+        }
+
+        void missingHandler(const QHttpServerRequest &, QHttpServerResponder &&) override
+        {
+            Q_ASSERT(false);
+        }
+    } server;
+
+    QHttpServerConfiguration configuration;
+    configuration.setPipelineDepth(3);
+    server.setConfiguration(configuration);
+
+    auto tcpServer = new QTcpServer;
+    QVERIFY(tcpServer->listen());
+    server.bind(tcpServer);
+
+    QTcpSocket client;
+    client.connectToHost(QHostAddress::LocalHost, tcpServer->serverPort());
+    QVERIFY(client.waitForConnected());
+    client.write("GET /slow HTTP/1.1\r\nHost: localhost\r\n\r\n"
+                 "GET /first HTTP/1.1\r\nHost: localhost\r\n\r\n"
+                 "GET /second HTTP/1.1\r\nHost: localhost\r\n\r\n"
+                 "GET /third HTTP/1.1\r\nHost: localhost\r\n\r\n");
+
+    // Three requests are handled ahead, the fourth waits for a free slot
+    QTRY_COMPARE(server.handled, QStringList({ u"/slow"_s, u"/first"_s, u"/second"_s }));
+    QTest::qWait(50);
+    QCOMPARE(server.handled.size(), 3);
+    QVERIFY(client.readAll().isEmpty());
+
+    QCOMPARE(server.delayed.size(), size_t(1));
+    server.delayed.front().write("/slow"_ba, "text/plain"_ba);
+    server.delayed.clear();
+
+    QTRY_COMPARE(server.handled.size(), 4);
+    QByteArray response;
+    QTRY_VERIFY((response += client.readAll()).endsWith("/third"));
+
+    // The responses come in the order of the requests
+    const qsizetype slow = response.indexOf("\r\n\r\n/slow");
+    const qsizetype first = response.indexOf("\r\n\r\n/first");
+    const qsizetype second = response.indexOf("\r\n\r\n/second");
+    const qsizetype third = response.indexOf("\r\n\r\n/third");
+    QVERIFY(slow > 0);
+    QVERIFY(slow < first);
+    QVERIFY(first < second);
+    QVERIFY(second < third);
+}
+
+void tst_QAbstractHttpServer::requestLimits_data()
+{
+    QTest::addColumn<QByteArray>("request");
+    QTest::addColumn<int>("status");
+
+    QTest::addRow("within limits")
+            << QByteArray("POST / HTTP/1.1\r\nHost: localhost\r\nContent-Length: 16\r\n\r\n"
+                          "0123456789abcdef")
+            << 200;
+    QTest::addRow("long request line")
+            << "GET /" + QByteArray(100, 'a') + " HTTP/1.1\r\nHost: localhost\r\n\r\n"
+            << 414;
+    QTest::addRow("unterminated request line") << "GET /" + QByteArray(100, 'a') << 414;
+    QTest::addRow("large header")
+            << "GET / HTTP/1.1\r\nHost: localhost\r\nX-Test: " + QByteArray(300, 'a')
+            << 431;
+    QTest::addRow("many headers")
+            << QByteArray("GET / HTTP/1.1\r\nHost: localhost\r\nA: 1\r\nB: 2\r\nC: 3\r\n"
+                          "D: 4\r\n\r\n")
+            << 431;
+    QTest::addRow("large content length")
+            << QByteArray("POST / HTTP/1.1\r\nHost: localhost\r\nContent-Length: 17\r\n\r\n")
+            << 413;
+    QTest::addRow("large chunk")
+            << QByteArray("POST / HTTP/1.1\r\nHost: localhost\r\n"
+                          "Transfer-Encoding: chunked\r\n\r\n"
+                          "a\r\n0123456789\r\n"
+                          "7\r\n0123456")
+            << 413;
+}
+
+void tst_QAbstractHttpServer::requestLimits()
+{
+    QFETCH(QByteArray, request);
+    QFETCH(int, status);
+
+    struct HttpServer : QAbstractHttpServer
+    {
+        bool handled = false;
+
+        bool handleRequest(const QHttpServerRequest &, QHttpServerResponder &responder) override
+        {
+            handled = true;
+            responder.write(QHttpServerResponder::StatusCode::Ok);
+            return true;
+        }
+
+        void missingHandler(const QHttpServerRequest &, QHttpServerResponder &&) override
+        {
+            Q_ASSERT(false);
+        }
+    } server;
+
+    QHttpServerConfiguration configuration;
+    configuration.setMaxRequestLineSize(64);
+    configuration.setMaxHeaderSize(256);
+    configuration.setMaxHeaderCount(4);
+    configuration.setMaxBodySize(16);
+    server.setConfiguration(configuration);
+
+    auto tcpServer = new QTcpServer;
+    QVERIFY(tcpServer->listen());
+    server.bind(tcpServer);
+
+    QTcpSocket client;
+    client.connectToHost(QHostAddress::LocalHost, tcpServer->serverPort());
+    QVERIFY(client.waitForConnected());
+    client.write(request);
+
+    QByteArray response;
+    QTRY_VERIFY((response += client.readAll()).contains("\r\n\r\n"));
+    QVERIFY2(response.startsWith("HTTP/1.1 " + QByteArray::number(status) + ' '),
+             response.constData());
+    QCOMPARE(server.handled, status == 200);
+    if (status != 200) {
+        QVERIFY(response.contains("\r\nConnection: close\r\n"));
+        QTRY_COMPARE(client.state(), QAbstractSocket::UnconnectedState);
+    }
+}
+
+void tst_QAbstractHttpServer::sequentialBody()
+{
+    // A device without a known size, like a pipe or a socket. It has no
+    // data yet when the response starts, and produces it in pieces over
+    // several iterations of the event loop.
+    struct SequentialDevice : QIODevice
+    {
+        QByteArray data;
+        QByteArray pending;
+
+        explicit SequentialDevice(const QByteArray &data) : pending(data)
+        {
+            open(ReadOnly);
+            startTimer(0);
+        }
+
+        bool isSequential() const override { return true; }
+        qint64 bytesAvailable() const override
+        {
+            return data.size() + QIODevice::bytesAvailable();
+        }
+
+    protected:
+        void timerEvent(QTimerEvent *event) override
+        {
+            const qsizetype size = qMin(pending.size(), qsizetype(100 * 1024));
+            data += pending.first(size);
+            pending.remove(0, size);
+            emit readyRead();
+            if (pending.isEmpty()) {
+                killTimer(event->timerId());
+                emit readChannelFinished();
+            }
+        }
+        qint64 readData(char *out, qint64 maxSize) override
+        {
+            const qint64 size = qMin(maxSize, qint64(data.size()));
+            memcpy(out, data.constData(), size);
+            data.remove(0, size);
+            return size;
+        }
+        qint64 writeData(const char *, qint64) override { return -1; }
+    };
+
+    // Large enough for several reads of growing size
+    QByteArray body;
+    for (int i = 0; body.size() < 1024 * 1024; ++i)
+        body += QByteArray::number(i) + ' ';
+
+    struct HttpServer : QAbstractHttpServer
+    {
+        QByteArray body;
+
+        bool handleRequest(const QHttpServerRequest &request,
+                           QHttpServerResponder &responder) override
+        {
+            if (request.url().path() == "/stream"_L1)
+                responder.write(new SequentialDevice(body), "text/plain");
+            else
+                responder.write(QHttpServerResponder::StatusCode::Ok);
+            return true;
+        }
+
+        void missingHandler(const QHttpServerRequest &, QHttpServerResponder &&) override
+        {
+            Q_ASSERT(false);
+        }
+    } server;
+    server.body = body;
+
+    auto tcpServer = new QTcpServer;
+    QVERIFY(tcpServer->listen());
+    server.bind(tcpServer);
+
+    // HTTP/1.1 clients get chunks, and the connection stays usable
+    {
+        QTcpSocket client;
+        client.connectToHost(QHostAddress::LocalHost, tcpServer->serverPort());
+        QVERIFY(client.waitForConnected());
+        client.write("GET /stream HTTP/1.1\r\nHost: localhost\r\n\r\n");
+
+        QByteArray response;
+        QTRY_VERIFY((response += client.readAll()).endsWith("\r\n0\r\n\r\n"));
+        const qsizetype headEnd = response.indexOf("\r\n\r\n") + 4;
+        const QByteArray head = response.first(headEnd);
+        QVERIFY(head.contains("\r\nTransfer-Encoding: chunked\r\n"));
+        QVERIFY(!head.contains("Content-Length"));
+
+        QByteArray decoded;
+        QByteArrayView chunks = QByteArrayView(response).sliced(headEnd);
+        for (;;) {
+            const qsizetype lineEnd = chunks.indexOf("\r\n");
+            QVERIFY(lineEnd > 0);
+            bool ok = false;
+            const qsizetype size = chunks.first(lineEnd).toLongLong(&ok, 16);
+            QVERIFY(ok);
+            chunks = chunks.sliced(lineEnd + 2);
+            if (size == 0)
+                break;
+            decoded += chunks.first(size);
+            QVERIFY(chunks.sliced(size).startsWith("\r\n"));
+            chunks = chunks.sliced(size + 2);
+        }
+        QCOMPARE(decoded, body);
+        QCOMPARE(chunks.toByteArray(), QByteArray("\r\n"));
+
+        client.write("GET / HTTP/1.1\r\nHost: localhost\r\n\r\n");
+        response.clear();
+        QTRY_VERIFY((response += client.readAll()).contains("\r\n\r\n"));
+        QVERIFY(response.startsWith("HTTP/1.1 200 OK\r\n"));
+    }
+
+    // HTTP/1.0 clients do not know chunks, the body ends with the connection
+    {
+        QTcpSocket client;
+        client.connectToHost(QHostAddress::LocalHost, tcpServer->serverPort());
+        QVERIFY(client.waitForConnected());
+        client.write("GET /stream HTTP/1.0\r\nConnection: keep-alive\r\n\r\n");
+
+        QByteArray response;
+        QTRY_COMPARE(client.state(), QAbstractSocket::UnconnectedState);
+        response += client.readAll();
+        const qsizetype headEnd = response.indexOf("\r\n\r\n") + 4;
+        QVERIFY(response.first(headEnd).contains("\r\nConnection: close\r\n"));
+        QVERIFY(!response.first(headEnd).contains("Transfer-Encoding"));
+        QCOMPARE(response.sliced(headEnd), body);
+    }
+}
+
+void tst_QAbstractHttpServer::transferFlowControl()
+{
+    // Far more than the socket buffers hold
+    static constexpr qint64 BodySize = 64 * 1024 * 1024;
+    static constexpr qint64 MaxReadSize = 512 * 1024;
+
+    // Records the size of each read the transfer makes
+    struct RecordingDevice : QIODevice
+    {
+        qint64 bodySize;
+        std::vector<qint64> *reads;
+
+        RecordingDevice(qint64 bodySize, std::vector<qint64> *reads)
+            : bodySize(bodySize), reads(reads)
+        {
+            open(ReadOnly | Unbuffered);
+        }
+
+        qint64 size() const override { return bodySize; }
+
+    protected:
+        qint64 readData(char *out, qint64 maxSize) override
+        {
+            reads->push_back(maxSize);
+            const qint64 size = qMin(maxSize, bodySize - pos());
+            memset(out, 'x', size);
+            return size;
+        }
+        qint64 writeData(const char *, qint64) override { return -1; }
+    };
+
+    struct HttpServer : QAbstractHttpServer
+    {
+        std::vector<qint64> reads;
+
+        bool handleRequest(const QHttpServerRequest &,
+                           QHttpServerResponder &responder) override
+        {
+            responder.write(new RecordingDevice(BodySize, &reads), "application/octet-stream");
+            return true;
+        }
+
+        void missingHandler(const QHttpServerRequest &, QHttpServerResponder &&) override
+        {
+            Q_ASSERT(false);
+        }
+    } server;
+
+    QHttpServerConfiguration configuration;
+    configuration.setTransferBufferSize(MaxReadSize);
+    server.setConfiguration(configuration);
+
+    auto tcpServer = new QTcpServer;
+    QVERIFY(tcpServer->listen());
+    server.bind(tcpServer);
+
+    // The client reads nothing, so that the socket of the server fills up
+    QTcpSocket client;
+    client.setReadBufferSize(64 * 1024);
+    client.connectToHost(QHostAddress::LocalHost, tcpServer->serverPort());
+    QVERIFY(client.waitForConnected());
+    client.write("GET / HTTP/1.1\r\nHost: localhost\r\n\r\n");
+
+    QTRY_VERIFY(!server.reads.empty());
+    size_t pausedReads;
+    do {
+        pausedReads = server.reads.size();
+        QTest::qWait(200);
+    } while (server.reads.size() != pausedReads);
+    const qint64 pausedTotal = std::accumulate(server.reads.cbegin(), server.reads.cend(),
+                                               qint64(0));
+    QVERIFY2(pausedTotal < BodySize, "The transfer did not wait for the client");
+
+    // Reads double while the device fills the buffer, up to the configured
+    // transfer buffer size
+    QVERIFY(server.reads.size() >= 5);
+    QCOMPARE(server.reads[0], qint64(64 * 1024));
+    QCOMPARE(server.reads[1], qint64(128 * 1024));
+    QCOMPARE(server.reads[2], qint64(256 * 1024));
+    QCOMPARE(server.reads[3], MaxReadSize);
+    QCOMPARE(server.reads[4], MaxReadSize);
+
+    const QByteArray response = client.readAll();
+    const qsizetype headEnd = response.indexOf("\r\n\r\n") + 4;
+    QVERIFY(headEnd >= 4);
+    QVERIFY(response.first(headEnd).contains("\r\nContent-Length: "
+                                             + QByteArray::number(BodySize) + "\r\n"));
+
+    // Once the client drains the socket, the transfer resumes and completes
+    client.setReadBufferSize(0);
+    qint64 received = response.size() - headEnd;
+    QTRY_COMPARE_WITH_TIMEOUT((received += client.readAll().size()), BodySize, 30000);
+
+    QVERIFY(server.reads.size() > pausedReads);
+    QVERIFY(std::all_of(server.reads.cbegin() + 3, server.reads.cend(),
+                        [](qint64 size) { return size == MaxReadSize; }));
+}
+
+void tst_QAbstractHttpServer::disconnectDuringTransfer_data()
+{
+    QTest::addColumn<bool>("fromFile");
+
+    QTest::addRow("buffer") << false;
+    QTest::addRow("file") << true;
+}
+
+void tst_QAbstractHttpServer::disconnectDuringTransfer()
+{
+    QFETCH(bool, fromFile);
+
+    // Far more than the socket buffers hold, so that the transfer waits for
+    // the client
+    const QByteArray body(32 * 1024 * 1024, 'x');
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(u"body.bin"_s);
+    if (fromFile) {
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QCOMPARE(file.write(body), qint64(body.size()));
+    }
+
+    struct HttpServer : QAbstractHttpServer
+    {
+        QByteArray body;
+        QString fileName;
+
+        bool handleRequest(const QHttpServerRequest &,
+                           QHttpServerResponder &responder) override
+        {
+            if (fileName.isEmpty()) {
+                auto buffer = new QBuffer;
+                buffer->setData(body);
+                responder.write(buffer, "application/octet-stream");
+            } else {
+                responder.write(new QFile(fileName), "application/octet-stream");
+            }
+            return true;
+        }
+
+        void missingHandler(const QHttpServerRequest &, QHttpServerResponder &&) override
+        {
+            Q_ASSERT(false);
+        }
+    } server;
+    if (fromFile)
+        server.fileName = fileName;
+    else
+        server.body = body;
+
+    QHttpServerConfiguration configuration;
+    configuration.setMaxConnections(1);
+    server.setConfiguration(configuration);
+
+    auto tcpServer = new QTcpServer;
+    QVERIFY(tcpServer->listen());
+    server.bind(tcpServer);
+
+    // Each client leaves in the middle of the body. Only one connection is
+    // accepted at a time, so the next client is only served if the server
+    // released the previous connection.
+    for (int i = 0; i < 3; ++i) {
+        QTcpSocket client;
+        client.setReadBufferSize(64 * 1024);
+        client.connectToHost(QHostAddress::LocalHost, tcpServer->serverPort());
+        QVERIFY(client.waitForConnected());
+        client.write("GET / HTTP/1.1\r\nHost: localhost\r\n\r\n");
+        QTRY_VERIFY(client.bytesAvailable() >= 12);
+        QCOMPARE(client.read(12), "HTTP/1.1 200"_ba);
+        client.abort();
+
+        // The connection, with its socket, is gone
+        QTRY_VERIFY(server.findChildren<QTcpSocket *>().isEmpty());
+    }
+
+    // A client that stops reading is dropped after the write timeout, also
+    // while a file is sent with sendfile()
+    using namespace std::chrono_literals;
+    configuration.setWriteTimeout(300ms);
+    server.setConfiguration(configuration);
+    QTcpSocket client;
+    client.setReadBufferSize(64 * 1024);
+    client.connectToHost(QHostAddress::LocalHost, tcpServer->serverPort());
+    QVERIFY(client.waitForConnected());
+    client.write("GET / HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    QTRY_VERIFY(client.bytesAvailable() >= 12);
+    QTRY_VERIFY(server.findChildren<QTcpSocket *>().isEmpty());
+}
+
 QT_END_NAMESPACE
 
 QTEST_MAIN(tst_QAbstractHttpServer)
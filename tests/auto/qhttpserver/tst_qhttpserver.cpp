@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
 
 #include <QtHttpServer/qhttpserver.h>
+#include <QtHttpServer/qhttpserverconfiguration.h>
 #include <QtHttpServer/qhttpserverrequest.h>
 #include <QtHttpServer/qhttpserverrouterrule.h>
 
@@ -15,10 +16,12 @@
 #include <QtCore/qlist.h>
 #include <QtCore/qbytearray.h>
 #include <QtCore/qdatetime.h>
+#include <QtCore/qfile.h>
 #include <QtCore/qmetaobject.h>
 #include <QtCore/qjsonobject.h>
 #include <QtCore/qjsonvalue.h>
 #include <QtCore/qjsonarray.h>
+#include <QtCore/qtemporarydir.h>
 #include <QtCore/qtimer.h>
 
 #include <QtNetwork/qnetworkaccessmanager.h>
@@ -35,6 +38,7 @@
 #endif
 
 #include <array>
+#include <memory>
 
 #if QT_CONFIG(ssl)
 
@@ -175,6 +179,11 @@ private slots:
     void disconnectedInEventLoop();
     void multipleRequests();
     void pipelinedRequests();
+    void streamingBody();
+    void largeFile();
+    void conditionalRequests();
+    void conditionalHeaders_data();
+    void conditionalHeaders();
     void missingHandler();
     void pipelinedFutureRequests();
     void multipleResponses();
@@ -330,6 +339,13 @@ void tst_QHttpServer::initTestCase()
         };
     });
 
+    httpserver.route("/content-type/", QHttpServerRequest::Method::Get, "text/csv"_ba,
+                     [] (const QString &type) -> QHttpServerResponse {
+        if (type == "explicit"_L1)
+            return QHttpServerResponse("text/plain"_ba, "a,b"_ba);
+        return QHttpServerResponse("a,b"_ba);
+    });
+
     httpserver.route("/data-and-custom-status-code/", []() {
         return QHttpServerResponse(QJsonObject{ { "key", "value" } },
                                    QHttpServerResponder::StatusCode::Accepted);
@@ -477,6 +493,30 @@ void tst_QHttpServer::routeGet_data()
         << "text/plain"
         << "page: 10 detail";
 
+    QTest::addRow("arg:int max")
+        << urlBase.arg("/page/2147483647")
+        << 200
+        << "text/plain"
+        << "page: 2147483647";
+
+    QTest::addRow("arg:int min")
+        << urlBase.arg("/page/-2147483648")
+        << 200
+        << "text/plain"
+        << "page: -2147483648";
+
+    QTest::addRow("arg:int overflow")
+        << urlBase.arg("/page/2147483648")
+        << 400
+        << "application/x-empty"
+        << "";
+
+    QTest::addRow("arg:uint overflow")
+        << urlBase.arg("/page/99999999999/detail")
+        << 400
+        << "application/x-empty"
+        << "";
+
     QTest::addRow("arg:-uint")
         << urlBase.arg("/page/-10/detail")
         << 404
@@ -610,6 +650,18 @@ void tst_QHttpServer::routeGet_data()
         << "application/json"
         << "[1,\"2\",{\"name\":\"test\"}]";
 
+    QTest::addRow("content type of route")
+        << urlBase.arg("/content-type/default")
+        << 200
+        << "text/csv"
+        << "a,b";
+
+    QTest::addRow("content type of response")
+        << urlBase.arg("/content-type/explicit")
+        << 200
+        << "text/plain"
+        << "a,b";
+
     QTest::addRow("data-and-custom-status-code")
             << urlBase.arg("/data-and-custom-status-code/") << 202 << "application/json"
             << "{\"key\":\"value\"}";
@@ -856,7 +908,7 @@ void tst_QHttpServer::routeDelete_data()
 
     QTest::addRow("post-and-get, delete")
         << urlBase.arg("/post-and-get")
-        << 404
+        << 405
         << "application/x-empty"
         << "";
 
@@ -870,7 +922,7 @@ void tst_QHttpServer::routeDelete_data()
 
     QTest::addRow("post-and-get, delete, ssl")
         << sslUrlBase.arg("/post-and-get")
-        << 404
+        << 405
         << "application/x-empty"
         << "";
 
@@ -965,7 +1017,8 @@ void tst_QHttpServer::afterRequest()
 {
     httpserver.afterRequest([] (QHttpServerResponse &&resp,
                                 const QHttpServerRequest &request) {
-        if (request.url().path() == "/test-after-request")
+        const QString path = request.url().path();
+        if (path == "/test-after-request" || path == "/post-and-get")
             resp.setHeader("Arguments-Order-1", "resp, request");
 
         return std::move(resp);
@@ -989,6 +1042,18 @@ void tst_QHttpServer::afterRequest()
     QCOMPARE(reply->rawHeader("Arguments-Order-1"), "resp, request");
     QCOMPARE(reply->rawHeader("Arguments-Order-2"), "request, resp");
     reply->deleteLater();
+
+    // A request with a method no route handles passes through the handlers too
+    reply = networkAccessManager.deleteResource(
+            QNetworkRequest(QUrl(urlBase.arg("/post-and-get"))));
+
+    QTRY_VERIFY(reply->isFinished());
+
+    QCOMPARE(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), 405);
+    QCOMPARE(reply->header(QNetworkRequest::ContentTypeHeader), "application/x-empty");
+    QCOMPARE(reply->rawHeader("Allow"), "GET, POST");
+    QCOMPARE(reply->rawHeader("Arguments-Order-1"), "resp, request");
+    reply->deleteLater();
 }
 
 void tst_QHttpServer::checkReply(QNetworkReply *reply, const QString &response) {
@@ -1054,6 +1119,349 @@ void tst_QHttpServer::pipelinedRequests()
         checkReply(replies[i], QString::number(i));
 }
 
+void tst_QHttpServer::streamingBody()
+{
+    auto viewHandler = [] () { };
+    using ViewHandler = decltype(viewHandler);
+
+    auto rule = std::make_unique<QHttpServerRouterRule>(
+            "/stream-body", QHttpServerRequest::Method::Post,
+            [](const QRegularExpressionMatch &, const QHttpServerRequest &request,
+               QHttpServerResponder &&responder) {
+                QVERIFY(request.body().isEmpty());
+                QIODevice *body = request.bodyDevice();
+                QVERIFY(body);
+                auto received = std::make_shared<QByteArray>();
+                QObject::connect(body, &QIODevice::readyRead, body, [body, received]() {
+                    received->append(body->readAll());
+                });
+                QObject::connect(body, &QIODevice::readChannelFinished, body,
+                                 [body, received, responder = std::move(responder)]() mutable {
+                    received->append(body->readAll());
+                    responder.write(QByteArray::number(received->size()) + ' '
+                                            + received->right(4),
+                                    "text/plain");
+                });
+            });
+    rule->setStreamingBody(true);
+    QVERIFY(rule->isStreamingBody());
+    QVERIFY(httpserver.router()->addRule<ViewHandler>(std::move(rule)));
+
+    // Larger than the buffer of the body device, so the socket is paused
+    // while the handler catches up
+    QByteArray payload;
+    for (int i = 0; payload.size() < 300 * 1024; ++i)
+        payload += QByteArray::number(i % 10000).rightJustified(4, '0');
+
+    QNetworkRequest request(QUrl(urlBase.arg("/stream-body")));
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/octet-stream");
+    auto reply = networkAccessManager.post(request, payload);
+    QTRY_VERIFY(reply->isFinished());
+    QCOMPARE(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), 200);
+    QCOMPARE(reply->readAll(), QByteArray::number(payload.size()) + ' ' + payload.right(4));
+    reply->deleteLater();
+
+    // Rules without streaming still get the whole body
+    reply = networkAccessManager.post(QNetworkRequest(QUrl(urlBase.arg("/post-body"))),
+                                      payload);
+    QTRY_VERIFY(reply->isFinished());
+    QCOMPARE(reply->readAll(), payload);
+    reply->deleteLater();
+}
+
+void tst_QHttpServer::largeFile()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(u"large.txt"_s);
+
+    // Larger than what fromFile() reads into memory, and than one send
+    QByteArray content;
+    for (int i = 0; content.size() < 3 * 1024 * 1024 + 17; ++i)
+        content += QByteArray::number(i).rightJustified(8, '0') + '\n';
+    {
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QCOMPARE(file.write(content), content.size());
+    }
+
+    const QHttpServerResponse response = QHttpServerResponse::fromFile(fileName);
+    QCOMPARE(response.statusCode(), QHttpServerResponse::StatusCode::Ok);
+    QCOMPARE(response.mimeType(), "text/plain"_ba);
+    QCOMPARE(response.data(), content);
+
+    httpserver.route("/large-file", [fileName]() {
+        return QHttpServerResponse::fromFile(fileName);
+    });
+    httpserver.route("/large-file-device", [fileName](QHttpServerResponder &&responder) {
+        responder.write(new QFile(fileName), "text/plain"_ba);
+    });
+
+    for (const auto path : { "/large-file"_L1, "/large-file-device"_L1 }) {
+        auto reply = networkAccessManager.get(QNetworkRequest(QUrl(urlBase.arg(path))));
+        QTRY_VERIFY(reply->isFinished());
+        QCOMPARE(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), 200);
+        QCOMPARE(reply->header(QNetworkRequest::ContentLengthHeader).toLongLong(),
+                 content.size());
+        QCOMPARE(reply->readAll(), content);
+        reply->deleteLater();
+
+        // Resuming a download only sends the rest of the file
+        QNetworkRequest request(QUrl(urlBase.arg(path)));
+        request.setRawHeader("Range", "bytes=1000000-");
+        reply = networkAccessManager.get(request);
+        QTRY_VERIFY(reply->isFinished());
+        QCOMPARE(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), 206);
+        QCOMPARE(reply->rawHeader("Content-Range"),
+                 "bytes 1000000-" + QByteArray::number(content.size() - 1) + '/'
+                         + QByteArray::number(content.size()));
+        QCOMPARE(reply->readAll(), content.sliced(1000000));
+        reply->deleteLater();
+    }
+
+    // The file is gone by the time the response is sent
+    const QHttpServerResponse removed = QHttpServerResponse::fromFile(fileName);
+    httpserver.route("/large-file-removed", [fileName]() {
+        QHttpServerResponse response = QHttpServerResponse::fromFile(fileName);
+        QFile::remove(fileName);
+        return response;
+    });
+    auto reply = networkAccessManager.get(QNetworkRequest(QUrl(urlBase.arg("/large-file-removed"))));
+    QTRY_VERIFY(reply->isFinished());
+    QCOMPARE(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), 404);
+    QVERIFY(reply->readAll().isEmpty());
+    reply->deleteLater();
+    QVERIFY(!QFile::exists(fileName));
+
+    QCOMPARE(QHttpServerResponse::fromFile(fileName).statusCode(),
+             QHttpServerResponse::StatusCode::NotFound);
+    QVERIFY(removed.data().isEmpty());
+}
+
+void tst_QHttpServer::conditionalRequests()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(u"large.txt"_s);
+    {
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QCOMPARE(file.write(QByteArray(100 * 1024, 'x')), qint64(100 * 1024));
+    }
+
+    QHttpServer server;
+    QHttpServerConfiguration configuration;
+    configuration.setConditionalRequestHandlingEnabled(true);
+    server.setConfiguration(configuration);
+
+    int revision = 1;
+    int built = 0;
+    server.route("/data", []() {
+        return QHttpServerResponse("dashboard data"_ba);
+    });
+    server.route("/file", [fileName]() {
+        return QHttpServerResponse::fromFile(fileName);
+    });
+    server.route("/revision", [&revision, &built](const QHttpServerRequest &request) {
+        const QByteArray etag = '"' + QByteArray::number(revision) + '"';
+        if (request.isNotModified(etag)) {
+            QHttpServerResponse response(QHttpServerResponse::StatusCode::NotModified);
+            response.setHeader("ETag"_ba, etag);
+            return response;
+        }
+        ++built;
+        QHttpServerResponse response("revision " + QByteArray::number(revision));
+        response.setHeader("ETag"_ba, etag);
+        return response;
+    });
+    httpserver.route("/conditional-disabled", []() {
+        return QHttpServerResponse("dashboard data"_ba);
+    });
+
+    const quint16 port = server.listen();
+    QVERIFY(port);
+    const auto get = [this, port](const QString &path, const QByteArray &header = {},
+                                  const QByteArray &value = {}) {
+        QNetworkRequest request(QUrl(u"http://localhost:%1%2"_s.arg(port).arg(path)));
+        if (!header.isEmpty())
+            request.setRawHeader(header, value);
+        return networkAccessManager.get(request);
+    };
+
+    auto reply = get(u"/data"_s);
+    QTRY_VERIFY(reply->isFinished());
+    QCOMPARE(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), 200);
+    QCOMPARE(reply->readAll(), "dashboard data"_ba);
+    const QByteArray etag = reply->rawHeader("ETag");
+    // Derived from the length and a digest of the content, the same on every
+    // server that sends it
+    QCOMPARE(etag, "\"e-WWAj_9Ti1mt2aquP\""_ba);
+    reply->deleteLater();
+
+    // Matching entity tags, also weak ones and in lists
+    const QByteArrayList matching = { etag, "W/" + etag, "\"other\", " + etag, "*"_ba };
+    for (const QByteArray &ifNoneMatch : matching) {
+        reply = get(u"/data"_s, "If-None-Match"_ba, ifNoneMatch);
+        QTRY_VERIFY(reply->isFinished());
+        QCOMPARE(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), 304);
+        QCOMPARE(reply->rawHeader("ETag"), etag);
+        QVERIFY(!reply->hasRawHeader("Content-Type"));
+        QVERIFY(!reply->hasRawHeader("Content-Length"));
+        QVERIFY(reply->readAll().isEmpty());
+        reply->deleteLater();
+    }
+
+    reply = get(u"/data"_s, "If-None-Match"_ba, "\"other\""_ba);
+    QTRY_VERIFY(reply->isFinished());
+    QCOMPARE(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), 200);
+    QCOMPARE(reply->readAll(), "dashboard data"_ba);
+    reply->deleteLater();
+
+    // Files that are sent from disk are not read for their validators
+    reply = get(u"/file"_s);
+    QTRY_VERIFY(reply->isFinished());
+    QCOMPARE(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), 200);
+    QVERIFY(reply->hasRawHeader("ETag"));
+    const QByteArray lastModified = reply->rawHeader("Last-Modified");
+    QVERIFY(lastModified.endsWith(" GMT"));
+    reply->deleteLater();
+
+    reply = get(u"/file"_s, "If-Modified-Since"_ba, lastModified);
+    QTRY_VERIFY(reply->isFinished());
+    QCOMPARE(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), 304);
+    QCOMPARE(reply->rawHeader("Last-Modified"), lastModified);
+    QVERIFY(reply->readAll().isEmpty());
+    reply->deleteLater();
+
+    reply = get(u"/file"_s, "If-Modified-Since"_ba, "Sunday, 06-Nov-94 08:49:37 GMT"_ba);
+    QTRY_VERIFY(reply->isFinished());
+    QCOMPARE(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), 200);
+    QCOMPARE(reply->readAll().size(), 100 * 1024);
+    reply->deleteLater();
+
+    // Handlers answer without building the body
+    reply = get(u"/revision"_s);
+    QTRY_VERIFY(reply->isFinished());
+    QCOMPARE(reply->readAll(), "revision 1"_ba);
+    QCOMPARE(built, 1);
+    reply->deleteLater();
+
+    reply = get(u"/revision"_s, "If-None-Match"_ba, "\"1\""_ba);
+    QTRY_VERIFY(reply->isFinished());
+    QCOMPARE(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), 304);
+    QCOMPARE(reply->rawHeader("ETag"), "\"1\""_ba);
+    QVERIFY(!reply->hasRawHeader("Content-Type"));
+    QCOMPARE(built, 1);
+    reply->deleteLater();
+
+    revision = 2;
+    reply = get(u"/revision"_s, "If-None-Match"_ba, "\"1\""_ba);
+    QTRY_VERIFY(reply->isFinished());
+    QCOMPARE(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), 200);
+    QCOMPARE(reply->readAll(), "revision 2"_ba);
+    QCOMPARE(built, 2);
+    reply->deleteLater();
+
+    // Off by default
+    QNetworkRequest request(QUrl(urlBase.arg("/conditional-disabled"_L1)));
+    request.setRawHeader("If-None-Match", "*");
+    reply = networkAccessManager.get(request);
+    QTRY_VERIFY(reply->isFinished());
+    QCOMPARE(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), 200);
+    QVERIFY(!reply->hasRawHeader("ETag"));
+    QCOMPARE(reply->readAll(), "dashboard data"_ba);
+    reply->deleteLater();
+}
+
+void tst_QHttpServer::conditionalHeaders_data()
+{
+    QTest::addColumn<QByteArray>("method");
+    QTest::addColumn<QByteArray>("ifNoneMatch");
+    QTest::addColumn<QByteArray>("ifModifiedSince");
+    QTest::addColumn<int>("status");
+
+    // The representation is "v1", last modified on Wed, 01 Jan 2020 00:00:00 GMT
+    QTest::addRow("imf-fixdate-same") << "GET"_ba << QByteArray()
+                                      << "Wed, 01 Jan 2020 00:00:00 GMT"_ba << 304;
+    QTest::addRow("imf-fixdate-later") << "GET"_ba << QByteArray()
+                                       << "Thu, 02 Jan 2020 00:00:00 GMT"_ba << 304;
+    QTest::addRow("imf-fixdate-earlier") << "GET"_ba << QByteArray()
+                                         << "Tue, 31 Dec 2019 23:59:59 GMT"_ba << 200;
+    QTest::addRow("rfc850-same") << "GET"_ba << QByteArray()
+                                 << "Wednesday, 01-Jan-20 00:00:00 GMT"_ba << 304;
+    // Two-digit years are at most 50 years in the future
+    QTest::addRow("rfc850-recent-year") << "GET"_ba << QByteArray()
+                                        << "Wednesday, 01-Jan-25 00:00:00 GMT"_ba << 304;
+    QTest::addRow("rfc850-last-century") << "GET"_ba << QByteArray()
+                                         << "Tuesday, 01-Jan-80 00:00:00 GMT"_ba << 200;
+    QTest::addRow("rfc850-earlier") << "GET"_ba << QByteArray()
+                                    << "Tuesday, 01-Jan-19 00:00:00 GMT"_ba << 200;
+    QTest::addRow("asctime-same") << "GET"_ba << QByteArray()
+                                  << "Wed Jan  1 00:00:00 2020"_ba << 304;
+    QTest::addRow("asctime-earlier") << "GET"_ba << QByteArray()
+                                     << "Tue Dec 31 23:59:59 2019"_ba << 200;
+    QTest::addRow("malformed-text") << "GET"_ba << QByteArray() << "yesterday"_ba << 200;
+    QTest::addRow("malformed-zone") << "GET"_ba << QByteArray()
+                                    << "Wed, 01 Jan 2020 00:00:00 UTC"_ba << 200;
+    QTest::addRow("malformed-day") << "GET"_ba << QByteArray()
+                                   << "Wed, 32 Jan 2020 00:00:00 GMT"_ba << 200;
+    QTest::addRow("malformed-time") << "GET"_ba << QByteArray()
+                                    << "Wed, 01 Jan 2020 25:00:00 GMT"_ba << 200;
+    QTest::addRow("empty") << "GET"_ba << QByteArray() << ""_ba << 200;
+
+    // If-None-Match decides alone when it is present
+    QTest::addRow("etag-match-over-old-date") << "GET"_ba << "\"v1\""_ba
+                                              << "Tue, 31 Dec 2019 23:59:59 GMT"_ba << 304;
+    QTest::addRow("etag-mismatch-over-new-date") << "GET"_ba << "\"v0\""_ba
+                                                 << "Thu, 02 Jan 2020 00:00:00 GMT"_ba << 200;
+
+    QTest::addRow("head-etag") << "HEAD"_ba << "\"v1\""_ba << QByteArray() << 304;
+    QTest::addRow("head-date") << "HEAD"_ba << QByteArray()
+                               << "Wed, 01 Jan 2020 00:00:00 GMT"_ba << 304;
+    QTest::addRow("head-mismatch") << "HEAD"_ba << "\"v0\""_ba << QByteArray() << 200;
+    // Only GET and HEAD requests are conditional this way
+    QTest::addRow("post-etag") << "POST"_ba << "\"v1\""_ba << QByteArray() << 200;
+}
+
+void tst_QHttpServer::conditionalHeaders()
+{
+    QFETCH(QByteArray, method);
+    QFETCH(QByteArray, ifNoneMatch);
+    QFETCH(QByteArray, ifModifiedSince);
+    QFETCH(int, status);
+
+    QHttpServer server;
+    QHttpServerConfiguration configuration;
+    configuration.setConditionalRequestHandlingEnabled(true);
+    server.setConfiguration(configuration);
+    server.route("/", []() {
+        QHttpServerResponse response("dashboard data"_ba);
+        response.setHeader("ETag"_ba, "\"v1\""_ba);
+        response.setHeader("Last-Modified"_ba, "Wed, 01 Jan 2020 00:00:00 GMT"_ba);
+        return response;
+    });
+    const quint16 port = server.listen();
+    QVERIFY(port);
+
+    QNetworkRequest request(QUrl(u"http://localhost:%1/"_s.arg(port)));
+    if (!ifNoneMatch.isNull())
+        request.setRawHeader("If-None-Match", ifNoneMatch);
+    if (!ifModifiedSince.isNull())
+        request.setRawHeader("If-Modified-Since", ifModifiedSince);
+    auto reply = networkAccessManager.sendCustomRequest(request, method);
+    QTRY_VERIFY(reply->isFinished());
+    QCOMPARE(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), status);
+    QCOMPARE(reply->rawHeader("ETag"), "\"v1\""_ba);
+    QCOMPARE(reply->rawHeader("Last-Modified"), "Wed, 01 Jan 2020 00:00:00 GMT"_ba);
+    if (status == 304) {
+        QVERIFY(!reply->hasRawHeader("Content-Length"));
+        QVERIFY(reply->readAll().isEmpty());
+    } else if (method == "GET") {
+        QCOMPARE(reply->readAll(), "dashboard data"_ba);
+    }
+    reply->deleteLater();
+}
+
 void tst_QHttpServer::missingHandler()
 {
     const QUrl requestUrl(urlBase.arg("/missing"));
@@ -1074,6 +1482,13 @@ void tst_QHttpServer::missingHandler()
         QTRY_VERIFY(reply->isFinished());
         QCOMPARE(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), 200);
         reply->deleteLater();
+
+        // The handler also replaces the 405 for paths routed for other methods
+        reply = networkAccessManager.deleteResource(
+                QNetworkRequest(QUrl(urlBase.arg("/post-and-get"))));
+        QTRY_VERIFY(reply->isFinished());
+        QCOMPARE(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), 200);
+        reply->deleteLater();
     }
 
     reply = networkAccessManager.get(QNetworkRequest(requestUrl));
@@ -0,0 +1,236 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtHttpServer/qhttpserver.h>
+#include <QtHttpServer/qhttpserverfilecache.h>
+
+#include <QtCore/qdir.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qresource.h>
+#include <QtCore/qtemporarydir.h>
+#include <QtNetwork/qtcpsocket.h>
+#include <QtTest/qtest.h>
+
+QT_BEGIN_NAMESPACE
+
+using namespace Qt::Literals;
+
+class tst_QHttpServerFileCache : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cachedFile();
+    void largeFile();
+    void compressedResource();
+    void outsideRoot_data();
+    void outsideRoot();
+    void changedFile();
+    void maxSize();
+    void route();
+
+private:
+    bool writeFile(const QString &name, const QByteArray &content);
+
+    std::unique_ptr<QTemporaryDir> dir;
+};
+
+bool tst_QHttpServerFileCache::writeFile(const QString &name, const QByteArray &content)
+{
+    QFile file(dir->filePath(name));
+    return file.open(QIODevice::WriteOnly | QIODevice::Truncate)
+            && file.write(content) == content.size();
+}
+
+void tst_QHttpServerFileCache::init()
+{
+    dir = std::make_unique<QTemporaryDir>();
+    QVERIFY(dir->isValid());
+    QVERIFY(QDir(dir->path()).mkdir(u"sub"_s));
+    QVERIFY(writeFile(u"index.html"_s, "<html><body>Hello</body></html>"_ba));
+    QVERIFY(writeFile(u"sub/data.json"_s, "{\"value\": 1}"_ba));
+}
+
+void tst_QHttpServerFileCache::cachedFile()
+{
+    QHttpServerFileCache cache(dir->path());
+    QCOMPARE(cache.rootPath(), QDir::cleanPath(dir->path()));
+    QCOMPARE(cache.size(), qint64(0));
+
+    const QHttpServerResponse response = cache.response(u"index.html"_s);
+    QCOMPARE(response.statusCode(), QHttpServerResponse::StatusCode::Ok);
+    QCOMPARE(response.mimeType(), "text/html"_ba);
+    QCOMPARE(response.data(), "<html><body>Hello</body></html>"_ba);
+    QCOMPARE(response.headers("ETag"_ba).size(), 1);
+    QCOMPARE(response.headers("Last-Modified"_ba).size(), 1);
+    QVERIFY(response.headers("Last-Modified"_ba).first().endsWith(" GMT"));
+    QCOMPARE(cache.size(), qint64(response.data().size()));
+
+    // The second response comes from the cache and shares its data
+    const QHttpServerResponse again = cache.response(u"index.html"_s);
+    QCOMPARE(again.data().constData(), response.data().constData());
+    QCOMPARE(again.headers("ETag"_ba), response.headers("ETag"_ba));
+
+    const QHttpServerResponse json = cache.response(u"sub/data.json"_s);
+    QCOMPARE(json.mimeType(), "application/json"_ba);
+    QCOMPARE(json.data(), "{\"value\": 1}"_ba);
+
+    QCOMPARE(cache.response(u"missing.html"_s).statusCode(),
+             QHttpServerResponse::StatusCode::NotFound);
+    QCOMPARE(cache.response(u"sub"_s).statusCode(), QHttpServerResponse::StatusCode::NotFound);
+
+    cache.clear();
+    QCOMPARE(cache.size(), qint64(0));
+    QCOMPARE(cache.response(u"index.html"_s).data(), "<html><body>Hello</body></html>"_ba);
+}
+
+void tst_QHttpServerFileCache::largeFile()
+{
+    const QByteArray content(300 * 1024, 'x');
+    QVERIFY(writeFile(u"large.txt"_s, content));
+
+    QHttpServerFileCache cache(dir->path());
+    cache.setMaxFileSize(64 * 1024);
+    QCOMPARE(cache.maxFileSize(), qint64(64 * 1024));
+
+    // Read from the file when needed, not kept in memory
+    const QHttpServerResponse response = cache.response(u"large.txt"_s);
+    QCOMPARE(response.statusCode(), QHttpServerResponse::StatusCode::Ok);
+    QCOMPARE(response.mimeType(), "text/plain"_ba);
+    QCOMPARE(response.headers("ETag"_ba).size(), 1);
+    QCOMPARE(cache.size(), qint64(0));
+    QCOMPARE(response.data(), content);
+}
+
+void tst_QHttpServerFileCache::compressedResource()
+{
+    // rcc compresses the repetitive content
+    const QString filePath = u":/data/compressed.txt"_s;
+    QVERIFY(QResource(filePath).compressionAlgorithm() != QResource::NoCompression);
+    QFile file(filePath);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QByteArray content = file.readAll();
+    QVERIFY(!content.isEmpty());
+    file.close();
+
+    QHttpServerFileCache cache(u":/data"_s);
+    const QHttpServerResponse response = cache.response(u"compressed.txt"_s);
+    QCOMPARE(response.statusCode(), QHttpServerResponse::StatusCode::Ok);
+    QCOMPARE(response.mimeType(), "text/plain"_ba);
+    QCOMPARE(response.data(), content);
+    // The data stays valid after the cache closed the resource
+    QCOMPARE(cache.size(), qint64(content.size()));
+    QCOMPARE(cache.response(u"compressed.txt"_s).data(), content);
+}
+
+void tst_QHttpServerFileCache::outsideRoot_data()
+{
+    QTest::addColumn<QString>("path");
+
+    QTest::addRow("parent") << u"../index.html"_s;
+    QTest::addRow("nested-parent") << u"sub/../../index.html"_s;
+    QTest::addRow("root") << u""_s;
+    QTest::addRow("dot") << u"."_s;
+}
+
+void tst_QHttpServerFileCache::outsideRoot()
+{
+    QFETCH(QString, path);
+
+    QHttpServerFileCache cache(dir->filePath(u"sub"_s));
+    QCOMPARE(cache.response(path).statusCode(), QHttpServerResponse::StatusCode::NotFound);
+    QCOMPARE(cache.response(u"data.json"_s).statusCode(), QHttpServerResponse::StatusCode::Ok);
+    QCOMPARE(cache.response(u"./data.json"_s).statusCode(), QHttpServerResponse::StatusCode::Ok);
+}
+
+void tst_QHttpServerFileCache::changedFile()
+{
+    QHttpServerFileCache cache(dir->path());
+    QCOMPARE(cache.response(u"index.html"_s).data(), "<html><body>Hello</body></html>"_ba);
+
+    QVERIFY(writeFile(u"index.html"_s, "<html><body>Changed</body></html>"_ba));
+    QTRY_COMPARE(cache.response(u"index.html"_s).data(), "<html><body>Changed</body></html>"_ba);
+
+    // Replaced as a whole, as deployments do
+    const QString replacement = dir->filePath(u"index.html.new"_s);
+    QVERIFY(writeFile(u"index.html.new"_s, "<html><body>Replaced</body></html>"_ba));
+    QVERIFY(QFile::remove(dir->filePath(u"index.html"_s)));
+    QVERIFY(QFile::rename(replacement, dir->filePath(u"index.html"_s)));
+    QTRY_COMPARE(cache.response(u"index.html"_s).data(), "<html><body>Replaced</body></html>"_ba);
+
+    QVERIFY(QFile::remove(dir->filePath(u"index.html"_s)));
+    QTRY_COMPARE(cache.response(u"index.html"_s).statusCode(),
+                 QHttpServerResponse::StatusCode::NotFound);
+}
+
+void tst_QHttpServerFileCache::maxSize()
+{
+    QHttpServerFileCache cache(dir->path());
+    cache.setMaxSize(40);
+    QCOMPARE(cache.maxSize(), qint64(40));
+
+    QCOMPARE(cache.response(u"index.html"_s).data(), "<html><body>Hello</body></html>"_ba);
+    QCOMPARE(cache.size(), qint64(31));
+
+    // Does not fit any more, but is still served
+    QCOMPARE(cache.response(u"sub/data.json"_s).data(), "{\"value\": 1}"_ba);
+    QCOMPARE(cache.size(), qint64(31));
+
+    // Copies share the cache
+    QHttpServerFileCache copy = cache;
+    copy.clear();
+    QCOMPARE(cache.size(), qint64(0));
+}
+
+void tst_QHttpServerFileCache::route()
+{
+    const QHttpServerFileCache cache(dir->filePath(u"sub"_s));
+    QHttpServer server;
+    server.route("/assets/<arg>", cache);
+    const quint16 port = server.listen(QHostAddress::LocalHost);
+    QVERIFY(port);
+
+    // Returns the head and the body of the response to a GET of path
+    const auto get = [port](const QByteArray &path, QByteArray *head, QByteArray *body) {
+        QTcpSocket client;
+        client.connectToHost(QHostAddress::LocalHost, port);
+        if (!client.waitForConnected())
+            return false;
+        client.write("GET " + path + " HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n");
+        QByteArray response;
+        QTest::qWaitFor([&]() {
+            response += client.readAll();
+            return client.state() == QAbstractSocket::UnconnectedState;
+        });
+        response += client.readAll();
+        const qsizetype headEnd = response.indexOf("\r\n\r\n");
+        if (headEnd < 0)
+            return false;
+        *head = response.first(headEnd + 2);
+        *body = response.sliced(headEnd + 4);
+        return true;
+    };
+
+    QByteArray head;
+    QByteArray body;
+    QVERIFY(get("/assets/data.json"_ba, &head, &body));
+    QVERIFY(head.startsWith("HTTP/1.1 200 OK\r\n"));
+    QCOMPARE(body, "{\"value\": 1}"_ba);
+    QVERIFY(head.contains("\r\nContent-Type: application/json\r\n"));
+    const QHttpServerResponse response = cache.response(u"data.json"_s);
+    QVERIFY(head.contains("\r\nETag: " + response.headers("ETag"_ba).first() + "\r\n"));
+    QVERIFY(head.contains("\r\nLast-Modified: " + response.headers("Last-Modified"_ba).first()
+                          + "\r\n"));
+
+    // index.html exists, but outside of the root
+    QVERIFY(get("/assets/../index.html"_ba, &head, &body));
+    QVERIFY(head.startsWith("HTTP/1.1 404 "));
+    QVERIFY(!body.contains("Hello"));
+}
+
+QT_END_NAMESPACE
+
+QTEST_MAIN(tst_QHttpServerFileCache)
+
+#include "tst_qhttpserverfilecache.moc"
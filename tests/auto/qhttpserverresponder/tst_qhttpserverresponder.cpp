@@ -4,6 +4,7 @@
 #include <QtHttpServer/qhttpserverresponder.h>
 #include <QtHttpServer/qabstracthttpserver.h>
 
+#include <QtCore/qbuffer.h>
 #include <QtCore/qjsondocument.h>
 #include <QtCore/qfile.h>
 #include <QtCore/qtemporaryfile.h>
@@ -41,7 +42,12 @@ private slots:
     void writeFile_data();
     void writeFile();
     void writeFileExtraHeader();
+    void writeRanges_data();
+    void writeRanges();
+    void writeMultipleRanges();
     void writeByteArrayExtraHeader();
+    void writeByteArraySize_data();
+    void writeByteArraySize();
 };
 
 #define qWaitForFinished(REPLY) QVERIFY(QSignalSpy(REPLY, &QNetworkReply::finished).wait())
@@ -231,6 +237,98 @@ void tst_QHttpServerResponder::writeFileExtraHeader()
     QCOMPARE(spyDestroyIoDevice.size(), 1);
 }
 
+void tst_QHttpServerResponder::writeRanges_data()
+{
+    QTest::addColumn<QByteArray>("range");
+    QTest::addColumn<QByteArray>("ifRange");
+    QTest::addColumn<int>("code");
+    QTest::addColumn<QByteArray>("contentRange");
+    QTest::addColumn<QByteArray>("body");
+
+    const QByteArray all = "0123456789abcdefghij"_ba;
+
+    QTest::addRow("single") << "bytes=2-5"_ba << QByteArray() << 206
+                            << "bytes 2-5/20"_ba << "2345"_ba;
+    QTest::addRow("open-ended") << "bytes=15-"_ba << QByteArray() << 206
+                                << "bytes 15-19/20"_ba << "fghij"_ba;
+    QTest::addRow("suffix") << "bytes=-3"_ba << QByteArray() << 206
+                            << "bytes 17-19/20"_ba << "hij"_ba;
+    QTest::addRow("clamped") << "bytes=18-100"_ba << QByteArray() << 206
+                             << "bytes 18-19/20"_ba << "ij"_ba;
+    QTest::addRow("unsatisfiable") << "bytes=20-"_ba << QByteArray() << 416
+                                   << "bytes */20"_ba << QByteArray();
+    QTest::addRow("invalid") << "bytes=5-2"_ba << QByteArray() << 200
+                             << QByteArray() << all;
+    QTest::addRow("unknown-unit") << "items=0-1"_ba << QByteArray() << 200
+                                  << QByteArray() << all;
+    QTest::addRow("if-range-match") << "bytes=0-0"_ba << "\"v1\""_ba << 206
+                                    << "bytes 0-0/20"_ba << "0"_ba;
+    QTest::addRow("if-range-changed") << "bytes=0-0"_ba << "\"v0\""_ba << 200
+                                      << QByteArray() << all;
+    QTest::addRow("if-range-weak") << "bytes=0-0"_ba << "W/\"v1\""_ba << 200
+                                   << QByteArray() << all;
+}
+
+void tst_QHttpServerResponder::writeRanges()
+{
+    QFETCH(QByteArray, range);
+    QFETCH(QByteArray, ifRange);
+    QFETCH(int, code);
+    QFETCH(QByteArray, contentRange);
+    QFETCH(QByteArray, body);
+
+    HttpServer server([](QHttpServerResponder responder) {
+        auto buffer = new QBuffer;
+        buffer->setData("0123456789abcdefghij"_ba);
+        responder.write(buffer, {{ "Content-Type"_ba, "text/plain"_ba },
+                                 { "ETag"_ba, "\"v1\""_ba }});
+    });
+    QNetworkRequest request(server.url);
+    request.setRawHeader("Range", range);
+    if (!ifRange.isNull())
+        request.setRawHeader("If-Range", ifRange);
+    auto reply = networkAccessManager->get(request);
+    QTRY_VERIFY(reply->isFinished());
+
+    QCOMPARE(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), code);
+    QCOMPARE(reply->rawHeader("Content-Range"), contentRange);
+    QCOMPARE(reply->rawHeader("Accept-Ranges"), "bytes"_ba);
+    QCOMPARE(reply->readAll(), body);
+}
+
+void tst_QHttpServerResponder::writeMultipleRanges()
+{
+    HttpServer server([](QHttpServerResponder responder) {
+        auto buffer = new QBuffer;
+        buffer->setData("0123456789abcdefghij"_ba);
+        responder.write(buffer, "text/plain"_ba);
+    });
+    QNetworkRequest request(server.url);
+    request.setRawHeader("Range", "bytes=0-1, 10-12");
+    auto reply = networkAccessManager->get(request);
+    QTRY_VERIFY(reply->isFinished());
+
+    QCOMPARE(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), 206);
+    const QByteArray contentType = reply->rawHeader("Content-Type");
+    const QByteArray prefix = "multipart/byteranges; boundary="_ba;
+    QVERIFY(contentType.startsWith(prefix));
+    const QByteArray boundary = contentType.sliced(prefix.size());
+
+    const QByteArray expected = "--" + boundary + "\r\n"
+            "Content-Type: text/plain\r\n"
+            "Content-Range: bytes 0-1/20\r\n\r\n"
+            "01\r\n"
+            "--" + boundary + "\r\n"
+            "Content-Type: text/plain\r\n"
+            "Content-Range: bytes 10-12/20\r\n\r\n"
+            "abc\r\n"
+            "--" + boundary + "--\r\n";
+    const QByteArray received = reply->readAll();
+    QCOMPARE(received, expected);
+    QCOMPARE(reply->header(QNetworkRequest::ContentLengthHeader).toLongLong(),
+             qint64(expected.size()));
+}
+
 void tst_QHttpServerResponder::writeByteArrayExtraHeader()
 {
     const QByteArray data("test data");
@@ -252,6 +350,35 @@ void tst_QHttpServerResponder::writeByteArrayExtraHeader()
     QCOMPARE(reply->readAll(), data);
 }
 
+void tst_QHttpServerResponder::writeByteArraySize_data()
+{
+    QTest::addColumn<qsizetype>("size");
+
+    QTest::addRow("small") << qsizetype(10);
+    QTest::addRow("4 KiB") << qsizetype(4096);
+    QTest::addRow("4 KiB + 1") << qsizetype(4097);
+    QTest::addRow("4 MiB") << qsizetype(4 * 1024 * 1024);
+}
+
+void tst_QHttpServerResponder::writeByteArraySize()
+{
+    QFETCH(qsizetype, size);
+
+    QByteArray data(size, Qt::Uninitialized);
+    for (qsizetype i = 0; i < size; ++i)
+        data[i] = char('a' + i % 26);
+
+    HttpServer server([=](QHttpServerResponder responder) {
+        responder.write(data, "text/plain"_ba);
+    });
+    auto reply = networkAccessManager->get(QNetworkRequest(server.url));
+    QTRY_VERIFY(reply->isFinished());
+
+    QCOMPARE(reply->error(), QNetworkReply::NoError);
+    QCOMPARE(reply->header(QNetworkRequest::ContentLengthHeader).toLongLong(), size);
+    QCOMPARE(reply->readAll(), data);
+}
+
 QT_END_NAMESPACE
 
 QTEST_MAIN(tst_QHttpServerResponder)
@@ -50,6 +50,10 @@ void tst_QHttpServerResponse::mimeTypeDetection_data()
     QTest::addRow("image/svg+xml")
              << QFINDTESTDATA("data/image.svg")
              << "image/svg+xml"_ba;
+
+    QTest::addRow("application/json")
+             << QFINDTESTDATA("data/application.json")
+             << "application/json"_ba;
 }
 
 void tst_QHttpServerResponse::mimeTypeDetection()
@@ -154,6 +158,12 @@ void tst_QHttpServerResponse::headers()
     QVERIFY(!resp.hasHeader(contentLengthHeader));
     QVERIFY(!resp.hasHeader(contentTypeHeader));
 
+    QHttpServerResponse text("text"_ba);
+    QVERIFY(text.hasHeader(contentTypeHeader, "text/plain"_ba));
+    text.clearHeader(contentTypeHeader);
+    QVERIFY(!text.hasHeader(contentTypeHeader));
+    QCOMPARE(text.mimeType(), "text/html"_ba);
+
     resp.addHeaders({ {contentTypeHeader, zero}, {contentLengthHeader, test1} });
 
     QVERIFY(resp.hasHeader(contentTypeHeader, zero));
@@ -59,6 +59,8 @@ private slots:
     void initTestCase();
     void routerRule_data();
     void routerRule();
+    void methodNotAllowed_data();
+    void methodNotAllowed();
     void viewHandlerNoArg();
     void viewHandlerOneArg();
     void viewHandlerTwoArgs();
@@ -91,6 +93,33 @@ void tst_QHttpServerRouter::initTestCase()
 
     httpserver.route("/get-only", QHttpServerRequest::Method::Get, getTest);
 
+    httpserver.route("/put-or-patch/<arg>",
+                     QHttpServerRequest::Method::Put | QHttpServerRequest::Method::Patch,
+                     [] (int, QHttpServerResponder &&responder) {
+        responder.write(QHttpServerResponder::StatusCode::Ok);
+    });
+
+    httpserver.route("/overlap/<arg>/end", [] (int value, QHttpServerResponder &&responder) {
+        responder.write(QString("int: %1").arg(value).toUtf8(), "text/plain");
+    });
+
+    httpserver.route("/overlap/<arg>/end",
+                     [] (const QString &value, QHttpServerResponder &&responder) {
+        responder.write(QString("string: %1").arg(value).toUtf8(), "text/plain");
+    });
+
+    httpserver.route("/overlap/literal/end", [] (QHttpServerResponder &&responder) {
+        responder.write(QString("literal").toUtf8(), "text/plain");
+    });
+
+    httpserver.route("/files/<arg>", [] (const QUrl &file, QHttpServerResponder &&responder) {
+        responder.write(QString("file: %1").arg(file.path()).toUtf8(), "text/plain");
+    });
+
+    httpserver.route("/reg.x", [] (QHttpServerResponder &&responder) {
+        responder.write(QString("regex").toUtf8(), "text/plain");
+    });
+
     urlBase = QStringLiteral("http://localhost:%1%2").arg(httpserver.listen());
 }
 
@@ -118,14 +147,14 @@ void tst_QHttpServerRouter::routerRule_data()
 
     QTest::addRow("/post-only [GET]")
         << "/post-only"
-        << 404
+        << 405
         << "application/x-empty"
         << ""
         << QNetworkAccessManager::GetOperation;
 
     QTest::addRow("/post-only [DELETE]")
         << "/post-only"
-        << 404
+        << 405
         << "application/x-empty"
         << ""
         << QNetworkAccessManager::DeleteOperation;
@@ -146,17 +175,66 @@ void tst_QHttpServerRouter::routerRule_data()
 
     QTest::addRow("/get-only [POST]")
         << "/get-only"
-        << 404
+        << 405
         << "application/x-empty"
         << ""
         << QNetworkAccessManager::PostOperation;
 
     QTest::addRow("/get-only [DELETE]")
         << "/get-only"
-        << 404
+        << 405
         << "application/x-empty"
         << ""
         << QNetworkAccessManager::DeleteOperation;
+
+    QTest::addRow("/overlap/12/end")
+        << "/overlap/12/end"
+        << 200
+        << "text/plain"
+        << "int: 12"
+        << QNetworkAccessManager::GetOperation;
+
+    QTest::addRow("/overlap/abc/end")
+        << "/overlap/abc/end"
+        << 200
+        << "text/plain"
+        << "string: abc"
+        << QNetworkAccessManager::GetOperation;
+
+    QTest::addRow("/overlap/literal/end")
+        << "/overlap/literal/end"
+        << 200
+        << "text/plain"
+        << "string: literal"
+        << QNetworkAccessManager::GetOperation;
+
+    QTest::addRow("/overlap/abc")
+        << "/overlap/abc"
+        << 404
+        << "application/x-empty"
+        << ""
+        << QNetworkAccessManager::GetOperation;
+
+    QTest::addRow("/files/a/b.txt")
+        << "/files/a/b.txt"
+        << 200
+        << "text/plain"
+        << "file: a/b.txt"
+        << QNetworkAccessManager::GetOperation;
+
+    QTest::addRow("/files")
+        << "/files"
+        << 404
+        << "application/x-empty"
+        << ""
+        << QNetworkAccessManager::GetOperation;
+
+    QTest::addRow("/reg-x")
+        << "/reg-x"
+        << 200
+        << "text/plain"
+        << "regex"
+        << QNetworkAccessManager::GetOperation;
 }
 
 void tst_QHttpServerRouter::routerRule()
@@ -193,6 +271,32 @@ void tst_QHttpServerRouter::routerRule()
     QCOMPARE(reply->readAll(), body);
 }
 
+void tst_QHttpServerRouter::methodNotAllowed_data()
+{
+    QTest::addColumn<QString>("url");
+    QTest::addColumn<int>("code");
+    QTest::addColumn<QByteArray>("allow");
+
+    QTest::addRow("/post-only") << "/post-only" << 405 << QByteArray("POST");
+    QTest::addRow("/put-or-patch/1") << "/put-or-patch/1" << 405 << QByteArray("PUT, PATCH");
+    QTest::addRow("/put-or-patch/x") << "/put-or-patch/x" << 404 << QByteArray();
+}
+
+void tst_QHttpServerRouter::methodNotAllowed()
+{
+    QFETCH(QString, url);
+    QFETCH(int, code);
+    QFETCH(QByteArray, allow);
+
+    QNetworkAccessManager networkAccessManager;
+    QNetworkReply *reply = networkAccessManager.get(QNetworkRequest(QUrl(urlBase.arg(url))));
+    QTRY_VERIFY(reply->isFinished());
+
+    QCOMPARE(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), code);
+    QCOMPARE(reply->rawHeader("Allow"), allow);
+    reply->deleteLater();
+}
+
 void tst_QHttpServerRouter::viewHandlerNoArg()
 {
     auto viewNonArg = [] () {